@@ -0,0 +1,249 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <set>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "catalyst.hpp"
+#include "batch.hpp"
+#include "file_io.hpp"
+
+// the files are processed in groups: while a group is encrypted on the catalyst::concurrency() threads, the next
+// one is being mapped and read ahead and the outputs of the previous one are being written, so at most three
+// groups are in flight at any time
+namespace {
+    // a group is closed once it holds that many bytes or files
+    constexpr size_t group_bytes = 64 << 20;
+    constexpr size_t group_files = 4096;
+
+    struct entry {
+        std::string input;
+        std::string output;
+        std::string error;
+    };
+
+    struct group {
+        std::vector<size_t> entries;
+        std::vector<std::unique_ptr<input_file>> inputs;
+        std::vector<std::vector<uint8_t>> outputs;
+    };
+
+    std::string output_name(const std::filesystem::path& input) {
+        std::filesystem::path output = input;
+        output.replace_extension(".out");
+        return output.string();
+    }
+
+    // the regular files of a directory (recursively), outputs of earlier runs are left out when encrypting
+    // and are the only ones taken when decrypting; or the files of a list, one name per line
+    std::vector<entry> list_entries(const std::string& source, bool encryption) {
+        std::vector<std::filesystem::path> inputs;
+
+        if (std::filesystem::is_directory(source)) {
+            for (const auto& f : std::filesystem::recursive_directory_iterator(source)) {
+                if (f.is_regular_file() && (f.path().extension() == ".out") != encryption) {
+                    inputs.push_back(f.path());
+                }
+            }
+            std::sort(inputs.begin(), inputs.end());
+        }
+        else {
+            std::ifstream list(source);
+            if (!list) {
+                throw std::runtime_error("Unable to read file: " + source);
+            }
+
+            std::string line;
+            while (std::getline(list, line)) {
+                if (!line.empty() && line.back() == '\r') {
+                    line.pop_back();
+                }
+                if (!line.empty()) {
+                    inputs.emplace_back(line);
+                }
+            }
+        }
+
+        std::vector<entry> entries;
+        std::set<std::string> outputs;
+        for (const auto& input : inputs) {
+            entry e = { input.string(), output_name(input), "" };
+            if (!outputs.insert(e.output).second) {
+                e.error = "output file " + e.output + " already written by another input";
+            }
+            entries.push_back(std::move(e));
+        }
+        return entries;
+    }
+
+    std::vector<group> make_groups(const std::vector<entry>& entries) {
+        std::vector<group> groups(1);
+        size_t bytes = 0;
+
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (!entries[i].error.empty()) {
+                continue;
+            }
+
+            std::error_code ec;
+            const uintmax_t size = std::filesystem::file_size(entries[i].input, ec);
+            if (groups.back().entries.size() == group_files || (bytes >= group_bytes && !groups.back().entries.empty())) {
+                groups.emplace_back();
+                bytes = 0;
+            }
+
+            groups.back().entries.push_back(i);
+            bytes += ec ? 0 : (size_t)size;
+        }
+
+        return groups;
+    }
+
+    void read_group(group& g, std::vector<entry>& entries) {
+        g.inputs.resize(g.entries.size());
+
+        for (size_t i = 0; i < g.entries.size(); ++i) {
+            entry& e = entries[g.entries[i]];
+            try {
+                g.inputs[i] = std::make_unique<input_file>(e.input);
+                g.inputs[i]->prefetch();
+            }
+            catch (const std::exception& error) {
+                e.error = error.what();
+            }
+        }
+    }
+
+    void process_group(group& g, std::vector<entry>& entries, const catalyst::key_context& key, bool encryption) {
+        std::vector<size_t> readable;
+        std::vector<std::span<const uint8_t>> data;
+        for (size_t i = 0; i < g.entries.size(); ++i) {
+            if (g.inputs[i]) {
+                readable.push_back(i);
+                data.push_back(g.inputs[i]->data());
+            }
+        }
+
+        g.outputs.assign(g.entries.size(), {});
+
+        std::vector<std::vector<uint8_t>> results;
+        try {
+            results = encryption ? catalyst::encrypt_serial_mt(data, key) : catalyst::decrypt_serial_mt(data, key);
+        }
+        catch (const std::exception&) {
+            // a malformed cipher (or any other failure, such as a group too large for memory) fails the whole group,
+            // which is done again file by file to find out which ones
+            results.assign(data.size(), {});
+            for (size_t j = 0; j < data.size(); ++j) {
+                try {
+                    results[j] = encryption ? catalyst::encrypt(data[j].data(), data[j].size(), key) : catalyst::decrypt(data[j].data(), data[j].size(), key);
+                }
+                catch (const std::exception& error) {
+                    entries[g.entries[readable[j]]].error = error.what();
+                    g.inputs[readable[j]].reset();
+                }
+            }
+        }
+
+        for (size_t j = 0; j < readable.size(); ++j) {
+            g.outputs[readable[j]] = std::move(results[j]);
+        }
+    }
+
+    void write_group(group& g, std::vector<entry>& entries) {
+        // the inputs are unmapped first, an output may replace its own input
+        for (size_t i = 0; i < g.entries.size(); ++i) {
+            const bool processed = g.inputs[i] != nullptr;
+            g.inputs[i].reset();
+
+            entry& e = entries[g.entries[i]];
+            if (!processed) {
+                continue;
+            }
+            try {
+                write_file(e.output, g.outputs[i]);
+            }
+            catch (const std::exception& error) {
+                e.error = error.what();
+            }
+            std::vector<uint8_t>().swap(g.outputs[i]);
+        }
+    }
+}
+
+int run_batch(const _execution_context& ectx) {
+    const bool encryption = ectx.mode == _internal_mode::encryption;
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<entry> entries;
+    try {
+        entries = list_entries(ectx.input_file_name, encryption);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return -1;
+    }
+
+    uint64_t bytes_in = 0;
+    uint64_t bytes_out = 0;
+
+    // the failures of a single file are reported with it, anything else (threads that cannot be started, a
+    // key schedule out of memory) stops the batch
+    try {
+        const catalyst::key_context key((uint8_t*)ectx.key.data(), ectx.key.size());
+        std::vector<group> groups = make_groups(entries);
+
+        std::future<void> reading = std::async(std::launch::async, [&]() { read_group(groups[0], entries); });
+        std::future<void> writing;
+
+        for (size_t g = 0; g < groups.size(); ++g) {
+            reading.get();
+            if (g + 1 < groups.size()) {
+                reading = std::async(std::launch::async, [&, g]() { read_group(groups[g + 1], entries); });
+            }
+
+            process_group(groups[g], entries, key, encryption);
+            for (size_t i = 0; i < groups[g].entries.size(); ++i) {
+                if (groups[g].inputs[i]) {
+                    bytes_in += groups[g].inputs[i]->data().size();
+                    bytes_out += groups[g].outputs[i].size();
+                }
+            }
+
+            if (writing.valid()) {
+                writing.get();
+            }
+            writing = std::async(std::launch::async, [&, g]() { write_group(groups[g], entries); });
+        }
+        if (writing.valid()) {
+            writing.get();
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return -1;
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t failed = 0;
+    for (const entry& e : entries) {
+        if (!e.error.empty()) {
+            std::cerr << e.input << ": " << e.error << std::endl;
+            ++failed;
+        }
+    }
+
+    printf("%s %zu files (%zu failed), %.2f MB in, %.2f MB out, %.3f s, %.2f MB/s on %zu threads\n",
+        encryption ? "encrypted" : "decrypted", entries.size() - failed, failed,
+        bytes_in / 1e6, bytes_out / 1e6, seconds, seconds > 0 ? bytes_in / seconds / 1e6 : 0.0, catalyst::concurrency());
+
+    return failed == 0 ? 0 : -1;
+}
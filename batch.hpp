@@ -0,0 +1,9 @@
+#pragma once
+
+#include <iostream>
+
+#include "commandline_args.hpp"
+
+// encrypts / decrypts every file of the directory or list file ectx.input_file_name, each one into its own
+// output file (as in the single file modes), prints a summary, returns the process exit code
+int run_batch(const _execution_context& ectx);
@@ -0,0 +1,856 @@
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <span>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "../devcatalyst/catalyst_internal.hpp"
+#include "../sha3/sha3.hpp"
+#include "../catalyst.hpp"
+
+namespace {
+    typedef std::chrono::steady_clock bench_clock;
+
+    constexpr uint64_t KiB = 1024;
+    constexpr uint64_t GiB = KiB * KiB * KiB;
+
+    static volatile uint64_t sink = 0;
+
+    // time stamp counter, 0 on targets without one (cycle columns then read 0)
+    inline uint64_t read_cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    // core cycles, instructions and last level cache misses of the calling thread from perf_event_open, a counter
+    // the kernel refuses (no PMU in a VM, perf_event_paranoid) stays closed and is left out of the results
+    class hw_counters {
+    public:
+        static constexpr size_t count = 3;
+        static constexpr const char* names[count] = { "hw cycles", "instructions", "llc misses" };
+
+        hw_counters() {
+            _fds.fill(-1);
+#if defined(__linux__)
+            const uint64_t events[count] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES };
+            for (size_t i = 0; i < count; ++i) {
+                perf_event_attr attr = {};
+                attr.size = sizeof(attr);
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = events[i];
+                attr.disabled = 1;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+                _fds[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+            }
+#endif
+        }
+        ~hw_counters() {
+#if defined(__linux__)
+            for (int fd : _fds) {
+                if (fd != -1) {
+                    close(fd);
+                }
+            }
+#endif
+        }
+        hw_counters(const hw_counters&) = delete;
+        hw_counters& operator=(const hw_counters&) = delete;
+
+        bool available() const {
+            return std::any_of(_fds.cbegin(), _fds.cend(), [](int fd) { return fd != -1; });
+        }
+
+        void start() {
+#if defined(__linux__)
+            for (int fd : _fds) {
+                if (fd != -1) {
+                    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+                }
+            }
+#endif
+        }
+
+        // counts since start, NaN for the closed counters, scaled up when the kernel multiplexed them
+        std::array<double, count> stop() {
+            std::array<double, count> values;
+            values.fill(NAN);
+#if defined(__linux__)
+            for (size_t i = 0; i < count; ++i) {
+                if (_fds[i] == -1) {
+                    continue;
+                }
+                ioctl(_fds[i], PERF_EVENT_IOC_DISABLE, 0);
+
+                // value, time enabled, time running
+                uint64_t data[3];
+                if (read(_fds[i], data, sizeof(data)) == (ssize_t)sizeof(data) && data[2] != 0) {
+                    values[i] = double(data[0]) * double(data[1]) / double(data[2]);
+                }
+            }
+#endif
+            return values;
+        }
+    private:
+        std::array<int, count> _fds;
+    };
+
+    hw_counters& counters() {
+        static hw_counters c;
+        return c;
+    }
+
+    struct measurement {
+        double seconds;
+        double cycles;
+        // per call, see hw_counters::names
+        std::array<double, hw_counters::count> hw;
+    };
+
+    // calls f until at least min_seconds went by (and at least once), returns the average cost of a call
+    template<typename F> measurement measure(F&& f, double min_seconds = 0.25) {
+        size_t calls = 0;
+        counters().start();
+        const auto start = bench_clock::now();
+        const uint64_t start_cycles = read_cycles();
+        std::chrono::duration<double> elapsed{};
+
+        do {
+            f();
+            ++calls;
+            elapsed = bench_clock::now() - start;
+        } while (elapsed.count() < min_seconds);
+
+        const uint64_t end_cycles = read_cycles();
+        std::array<double, hw_counters::count> hw = counters().stop();
+        for (double& v : hw) {
+            v /= calls;
+        }
+
+        return { elapsed.count() / calls, double(end_cycles - start_cycles) / calls, hw };
+    }
+
+    std::string format_size(uint64_t n) {
+        static const char* units[] = { "B", "KiB", "MiB", "GiB" };
+        size_t u = 0;
+        while (n >= 1024 && n % 1024 == 0 && u < 3) {
+            n /= 1024;
+            ++u;
+        }
+        return std::to_string(n) + " " + units[u];
+    }
+
+    // 16 B, 64 B, ... up to <max_size>
+    std::vector<uint64_t> size_sweep(uint64_t first, uint64_t max_size) {
+        std::vector<uint64_t> sizes;
+        for (uint64_t length = first; length <= max_size; length *= 4) {
+            sizes.push_back(length);
+        }
+        return sizes;
+    }
+
+    // a byte count, shown with its unit in the tables and as a plain number in JSON
+    struct byte_size {
+        uint64_t n;
+    };
+    typedef std::variant<std::string, uint64_t, double, byte_size> value;
+    // one measured configuration, a row of its table
+    typedef std::vector<std::pair<std::string, value>> result;
+
+    // MB/s and cycles/byte over <bytes> bytes per call, plus the cost of a call and the hardware counters,
+    // the keys start with <prefix>
+    void add_throughput(result& r, const measurement& m, double bytes, const std::string& prefix = "") {
+        r.emplace_back(prefix + "ns/call", m.seconds * 1e9);
+        r.emplace_back(prefix + "cycles/call", m.cycles);
+        r.emplace_back(prefix + "MB/s", bytes / m.seconds / 1e6);
+        r.emplace_back(prefix + "cycles/byte", m.cycles / bytes);
+
+        for (size_t i = 0; i < hw_counters::count; ++i) {
+            if (!std::isnan(m.hw[i])) {
+                r.emplace_back(prefix + hw_counters::names[i] + "/byte", m.hw[i] / bytes);
+            }
+        }
+    }
+
+    // tables printed row by row as they are measured, or with --json a single document once every suite ran
+    class report {
+    public:
+        explicit report(bool json) : _json(json) {}
+
+        // starts a table, <columns> are the keys shown in text mode (the JSON results keep every key)
+        void table(const std::string& name, const std::string& title, std::vector<std::string> columns) {
+            _tables.push_back({ name, title, std::move(columns), {} });
+
+            if (!_json) {
+                const table_data& t = _tables.back();
+                printf("\n%s\n", t.title.c_str());
+                for (size_t c = 0; c < t.columns.size(); ++c) {
+                    printf("%*s", width(c, t.columns[c]), t.columns[c].c_str());
+                }
+                printf("\n");
+            }
+        }
+
+        void add(result r) {
+            table_data& t = _tables.back();
+
+            if (!_json) {
+                for (size_t c = 0; c < t.columns.size(); ++c) {
+                    const auto it = std::find_if(r.cbegin(), r.cend(), [&](const auto& field) { return field.first == t.columns[c]; });
+                    printf("%*s", width(c, t.columns[c]), it == r.cend() ? "-" : text(it->second).c_str());
+                }
+                printf("\n");
+                fflush(stdout);
+            }
+
+            t.results.push_back(std::move(r));
+        }
+
+        void finish() const {
+            if (!_json) {
+                return;
+            }
+
+            printf("{\n  \"hardware_counters\": %s,\n  \"tables\": [", counters().available() ? "true" : "false");
+            for (size_t i = 0; i < _tables.size(); ++i) {
+                const table_data& t = _tables[i];
+                printf("%s\n    {\n      \"name\": %s,\n      \"title\": %s,\n      \"results\": [", i == 0 ? "" : ",", quote(t.name).c_str(), quote(t.title).c_str());
+
+                for (size_t j = 0; j < t.results.size(); ++j) {
+                    printf("%s\n        {", j == 0 ? "" : ",");
+                    for (size_t k = 0; k < t.results[j].size(); ++k) {
+                        const auto& [key, v] = t.results[j][k];
+                        printf("%s%s: %s", k == 0 ? " " : ", ", quote(key).c_str(), json(v).c_str());
+                    }
+                    printf(" }");
+                }
+                printf("\n      ]\n    }");
+            }
+            printf("\n  ]\n}\n");
+        }
+    private:
+        struct table_data {
+            std::string name;
+            std::string title;
+            std::vector<std::string> columns;
+            std::vector<result> results;
+        };
+
+        static int width(size_t column, const std::string& name) {
+            // the first column is left aligned
+            return column == 0 ? -26 : (int)std::max<size_t>(14, name.size() + 2);
+        }
+
+        static std::string text(const value& v) {
+            char buffer[64];
+            if (const std::string* s = std::get_if<std::string>(&v)) {
+                return *s;
+            }
+            if (const uint64_t* n = std::get_if<uint64_t>(&v)) {
+                return std::to_string(*n);
+            }
+            if (const byte_size* b = std::get_if<byte_size>(&v)) {
+                return format_size(b->n);
+            }
+
+            const double d = std::get<double>(v);
+            snprintf(buffer, sizeof(buffer), std::fabs(d) < 10 ? "%.3f" : "%.2f", d);
+            return buffer;
+        }
+
+        static std::string json(const value& v) {
+            char buffer[64];
+            if (const std::string* s = std::get_if<std::string>(&v)) {
+                return quote(*s);
+            }
+            if (const uint64_t* n = std::get_if<uint64_t>(&v)) {
+                return std::to_string(*n);
+            }
+            if (const byte_size* b = std::get_if<byte_size>(&v)) {
+                return std::to_string(b->n);
+            }
+
+            const double d = std::get<double>(v);
+            if (!std::isfinite(d)) {
+                return "null";
+            }
+            snprintf(buffer, sizeof(buffer), "%.6g", d);
+            return buffer;
+        }
+
+        static std::string quote(const std::string& s) {
+            std::string q = "\"";
+            for (char c : s) {
+                if (c == '"' || c == '\\') {
+                    q += '\\';
+                }
+                q += c;
+            }
+            return q + "\"";
+        }
+
+        bool _json;
+        std::vector<table_data> _tables;
+    };
+
+    std::vector<uint8_t> pattern(size_t length, uint8_t seed = 7) {
+        std::vector<uint8_t> data(length);
+        for (size_t i = 0; i < length; ++i) {
+            data[i] = (uint8_t)(i * 131 + seed);
+        }
+        return data;
+    }
+
+    void bench_constants(report& out, uint64_t max_size) {
+        const std::vector<uint32_t>& base = catalyst::constants::constants[0];
+
+        out.table("constants", "extend_constants", { "length", "ns/call", "MB/s", "cycles/byte" });
+
+        for (uint64_t length : size_sweep(KiB, max_size)) {
+            const measurement m = measure([&]() {
+                sink = catalyst::constants::extend_constants(base, length).size();
+            });
+
+            result r = { { "length", byte_size{ length } } };
+            add_throughput(r, m, length);
+            out.add(std::move(r));
+        }
+    }
+
+    void bench_keccak(report& out, uint64_t max_size) {
+        // SHA3-256 and SHAKE256 both absorb and squeeze 136 bytes per permutation
+        constexpr size_t rate = 136;
+        constexpr size_t permutations = 1000;
+
+        const std::pair<const char*, void(*)(uint64_t*)> variants[] = {
+            { "generic", &SHA3::internal::keccakf_generic },
+            { "unrolled", &SHA3::internal::keccakf_unrolled },
+            { "lane_complement", &SHA3::internal::keccakf_lane_complement }
+        };
+
+        out.table("keccak", std::string("keccak-f[1600] (sha3 built with: ") + SHA3::internal::keccakf_implementation() + ")",
+            { "permutation", "ns/perm", "cycles/perm", "MB/s", "cycles/byte" });
+
+        for (const auto& [name, keccakf] : variants) {
+            uint64_t s[25] = { 0 };
+            const measurement m = measure([&]() {
+                for (size_t i = 0; i < permutations; ++i) {
+                    keccakf(s);
+                }
+            });
+            sink = s[0];
+
+            result r = {
+                { "permutation", name },
+                { "ns/perm", m.seconds * 1e9 / permutations },
+                { "cycles/perm", m.cycles / permutations }
+            };
+            add_throughput(r, m, permutations * rate);
+            out.add(std::move(r));
+        }
+
+        out.table("sha3", "SHA3-256 / SHAKE256", { "function", "length", "MB/s", "cycles/byte", "instructions/byte" });
+
+        const uint64_t max_length = std::min<uint64_t>(max_size, 1024 * KiB);
+        std::vector<uint8_t> data = pattern(std::max<uint64_t>(max_length, 64 * KiB), 0xa5);
+        std::vector<uint8_t> digest(data.size());
+
+        const auto add = [&](const char* function, uint64_t length, const measurement& m) {
+            result r = { { "function", function }, { "length", byte_size{ length } } };
+            add_throughput(r, m, length);
+            out.add(std::move(r));
+        };
+
+        for (uint64_t length : size_sweep(16, max_length)) {
+            add("SHA3-256", length, measure([&]() {
+                SHA3::SHA3_256(data.data(), length, digest.data());
+            }));
+            add("SHAKE256 absorb", length, measure([&]() {
+                SHA3::SHAKE256(data.data(), length, digest.data(), 32);
+            }));
+            add("SHAKE256 squeeze", length, measure([&]() {
+                SHA3::SHAKE256(data.data(), 0, digest.data(), length);
+            }));
+        }
+
+        // independent 1 KiB inputs, one by one and through the multi-buffer API
+        const size_t n = 8 * SHA3::batch::width();
+        const size_t input_length = KiB;
+        std::vector<const uint8_t*> inputs(n);
+        std::vector<size_t> lengths(n, input_length);
+        std::vector<uint8_t*> digests(n);
+        for (size_t i = 0; i < n; ++i) {
+            inputs[i] = data.data() + i * input_length % (data.size() - input_length);
+            digests[i] = digest.data() + i * 32;
+        }
+
+        const measurement serial = measure([&]() {
+            for (size_t i = 0; i < n; ++i) {
+                SHA3::SHAKE256(inputs[i], lengths[i], digests[i], 32);
+            }
+        });
+        const measurement batch = measure([&]() {
+            SHA3::batch::SHAKE256(n, inputs.data(), lengths.data(), digests.data(), 32);
+        });
+
+        const std::string batch_name = "SHAKE256 x" + std::to_string(SHA3::batch::width());
+        add("SHAKE256 serial", n * input_length, serial);
+        add(batch_name.c_str(), n * input_length, batch);
+    }
+
+    // stage 3 substitution over 1 MiB with every kernel the CPU can run
+    void bench_sbox(report& out) {
+        typedef size_t(*kernel)(uint8_t*, size_t, const uint8_t*);
+
+        std::vector<std::pair<const char*, kernel>> kernels = { { "scalar", &catalyst::SBox::substitute_scalar } };
+#if defined(__x86_64__) || defined(__i386__)
+        if (__builtin_cpu_supports("ssse3")) {
+            kernels.emplace_back("ssse3", &catalyst::SBox::substitute_ssse3);
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            kernels.emplace_back("avx2", &catalyst::SBox::substitute_avx2);
+        }
+        if (__builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vbmi")) {
+            kernels.emplace_back("avx512vbmi", &catalyst::SBox::substitute_avx512vbmi);
+        }
+#endif
+
+        constexpr size_t length = 1024 * KiB;
+        std::vector<uint8_t> data = pattern(length);
+        const std::array<uint8_t, catalyst::SBox::sbox_size>& sbox = catalyst::SBox::get_sbox();
+
+        out.table("sbox", std::string("sbox substitution, 1 MiB (substitute uses: ") + catalyst::SBox::substitute_implementation() + ")",
+            { "kernel", "MB/s", "cycles/byte" });
+
+        for (const auto& [name, substitute] : kernels) {
+            const measurement m = measure([&]() {
+                sink = substitute(data.data(), data.size(), sbox.data());
+            });
+
+            result r = { { "kernel", name } };
+            add_throughput(r, m, length);
+            out.add(std::move(r));
+        }
+    }
+
+    // stage 2 word mixing over 1 MiB, per word through the sigma function pointer (as the stages used to)
+    // and through the mix / unmix kernels of every instruction set the CPU can run
+    void bench_sigma(report& out) {
+        typedef void(*kernel)(size_t, uint8_t*, size_t, size_t, const std::array<uint32_t, 32>&);
+
+        std::vector<std::tuple<const char*, kernel, kernel>> kernels = {
+            { "generic", &catalyst::sigmas::mix_generic, &catalyst::sigmas::unmix_generic }
+        };
+#if defined(__x86_64__) || defined(__i386__)
+        if (__builtin_cpu_supports("avx2")) {
+            kernels.emplace_back("avx2", &catalyst::sigmas::mix_avx2, &catalyst::sigmas::unmix_avx2);
+        }
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+            kernels.emplace_back("avx512", &catalyst::sigmas::mix_avx512, &catalyst::sigmas::unmix_avx512);
+        }
+        if (__builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vbmi") && __builtin_cpu_supports("gfni")) {
+            kernels.emplace_back("avx512+gfni", &catalyst::sigmas::mix_avx512, &catalyst::sigmas::unmix_gfni);
+        }
+#endif
+
+        constexpr size_t length = 1024 * KiB;
+        constexpr size_t n_words = length / sizeof(uint32_t);
+        std::vector<uint8_t> data = pattern(length);
+        const std::array<uint32_t, 32>& constants = catalyst::constants::sigma::constants[0];
+
+        out.table("sigma", std::string("stage 2 sigma mixing, 1 MiB (mix uses: ") + catalyst::sigmas::mix_implementation() + ")",
+            { "kernel", "sigma", "mix MB/s", "mix cycles/byte", "unmix MB/s", "unmix cycles/byte" });
+
+        const auto add = [&](const char* name, size_t index, const measurement& mix, const measurement& unmix) {
+            result r = { { "kernel", name }, { "sigma", (uint64_t)index } };
+            add_throughput(r, mix, length, "mix ");
+            add_throughput(r, unmix, length, "unmix ");
+            out.add(std::move(r));
+        };
+
+        for (size_t index = 0; index < catalyst::sigmas::sigmas.size(); ++index) {
+            uint32_t(*const sigma)(uint32_t) = catalyst::sigmas::sigmas[index];
+            uint32_t(*const Isigma)(uint32_t) = catalyst::sigmas::Isigmas[index];
+
+            const measurement pointer_mix = measure([&]() {
+                uint32_t* const words = (uint32_t*)data.data();
+                for (size_t i = 0; i < n_words; ++i) {
+                    words[i] = sigma(words[i] + constants[i % 32]);
+                }
+            });
+            const measurement pointer_unmix = measure([&]() {
+                uint32_t* const words = (uint32_t*)data.data();
+                for (size_t i = 0; i < n_words; ++i) {
+                    words[i] = Isigma(words[i]) - constants[i % 32];
+                }
+            });
+            add("function pointer", index, pointer_mix, pointer_unmix);
+
+            for (const auto& [name, mix, unmix] : kernels) {
+                const measurement m = measure([&]() {
+                    mix(index, data.data(), n_words, 0, constants);
+                });
+                const measurement u = measure([&]() {
+                    unmix(index, data.data(), n_words, 0, constants);
+                });
+                add(name, index, m, u);
+            }
+        }
+    }
+
+    // every stage and its inverse on its own, in place over a buffer of each length, with a 64 byte key
+    void bench_stages(report& out, uint64_t max_size) {
+        std::vector<uint8_t> key_data = pattern(64, 11);
+        const catalyst::key_context key(key_data.data(), key_data.size());
+        const catalyst::key_schedule& schedule = key.schedule();
+
+        out.table("stages", "single stages, in place", { "stage", "length", "MB/s", "cycles/byte", "instructions/byte", "llc misses/byte" });
+
+        for (uint64_t length : size_sweep(16, max_size)) {
+            std::vector<uint8_t> buffer = pattern(catalyst::max_cipher_size(length));
+            const std::span<uint8_t> data(buffer.data(), length);
+
+            // Istage4 reads the count byte of a real extension, kept apart from the buffer stage4 rewrites
+            const size_t cipher_length = catalyst::Staged::stage4(buffer, length, schedule);
+            const std::vector<uint8_t> cipher(buffer.cbegin(), buffer.cbegin() + cipher_length);
+
+            const std::pair<const char*, std::function<void()>> stages[] = {
+                { "stage1", [&]() { catalyst::Staged::stage1(data, data, schedule); } },
+                { "Istage1", [&]() { catalyst::Staged::Istage1(data, schedule); } },
+                { "stage2", [&]() { catalyst::Staged::stage2(data, schedule); } },
+                { "Istage2", [&]() { catalyst::Staged::Istage2(data, schedule); } },
+                { "stage3", [&]() { catalyst::Staged::stage3(data, schedule); } },
+                { "Istage3", [&]() { catalyst::Staged::Istage3(data, schedule); } },
+                // the extension only overwrites the bytes after the data
+                { "stage4", [&]() { sink = catalyst::Staged::stage4(buffer, length, schedule); } },
+                { "Istage4", [&]() { sink = catalyst::Staged::Istage4(cipher); } },
+                // its own inverse
+                { "stage5", [&]() { catalyst::Staged::stage5(data, data, schedule); } }
+            };
+
+            for (const auto& [name, f] : stages) {
+                result r = { { "stage", name }, { "length", byte_size{ length } } };
+                add_throughput(r, measure(f), length);
+                out.add(std::move(r));
+            }
+        }
+    }
+
+    // staged reference path against the fused tiled pipeline, both writing into a preallocated buffer
+    void bench_pipeline(report& out, uint64_t max_size) {
+        std::vector<uint8_t> key_data = pattern(64, 11);
+        const catalyst::key_context key(key_data.data(), key_data.size());
+
+        out.table("pipeline", "encrypt / decrypt pipeline", { "path", "length", "encrypt MB/s", "encrypt cycles/byte", "decrypt MB/s", "decrypt cycles/byte" });
+
+        for (uint64_t length : size_sweep(16, max_size)) {
+            std::vector<uint8_t> plain(length, 0x5a);
+            std::vector<uint8_t> cipher(catalyst::max_cipher_size(length));
+            std::vector<uint8_t> out_buffer(cipher.size());
+
+            const size_t cipher_length = catalyst::encrypt(plain, cipher, key);
+            const std::span<const uint8_t> c(cipher.data(), cipher_length);
+
+            const auto add = [&](const char* path, const measurement& enc, const measurement& dec) {
+                result r = { { "path", path }, { "length", byte_size{ length } } };
+                add_throughput(r, enc, length, "encrypt ");
+                add_throughput(r, dec, length, "decrypt ");
+                out.add(std::move(r));
+            };
+
+            add("staged", measure([&]() {
+                sink = catalyst::Staged::encrypt(plain, out_buffer, key.schedule());
+            }), measure([&]() {
+                sink = catalyst::Staged::decrypt(c, out_buffer, key.schedule());
+            }));
+            add("fused", measure([&]() {
+                sink = catalyst::Fused::encrypt(plain, out_buffer, key.schedule());
+            }), measure([&]() {
+                sink = catalyst::Fused::decrypt(c, out_buffer, key.schedule());
+            }));
+        }
+    }
+
+    // key_context construction, the MB/s and cycles/byte are over the key bytes
+    void bench_keys(report& out) {
+        out.table("keys", "key setup", { "key length", "ns/call", "cycles/call", "cycles/byte", "instructions/byte" });
+
+        for (uint64_t length : size_sweep(1, 4 * KiB)) {
+            std::vector<uint8_t> key_data = pattern(length, 11);
+
+            const measurement m = measure([&]() {
+                const catalyst::key_context key(key_data.data(), key_data.size());
+                sink = key.schedule().n_rounds;
+            });
+
+            result r = { { "key length", byte_size{ length } } };
+            add_throughput(r, m, length);
+            out.add(std::move(r));
+        }
+    }
+
+    // encrypt_serial_mt over a batch of equal messages and over a few large messages among many small ones,
+    // for 1, 2, 4, ... threads up to the CPUs the pool would use by default (the hardware counters only cover
+    // the calling thread, so they are left out)
+    void bench_threads(report& out) {
+        catalyst::set_concurrency(0);
+        const size_t max_threads = std::max<size_t>(catalyst::concurrency(), std::thread::hardware_concurrency());
+
+        std::vector<size_t> thread_counts;
+        for (size_t t = 1; t < max_threads; t *= 2) {
+            thread_counts.push_back(t);
+        }
+        thread_counts.push_back(max_threads);
+
+        std::vector<uint8_t> key_data = pattern(32, 11);
+        std::vector<uint8_t> data = pattern(1024 * KiB);
+
+        const auto make_batch = [&](const std::vector<size_t>& lengths) {
+            std::vector<catalyst::input_data> batch;
+            for (size_t length : lengths) {
+                batch.push_back({ length, data.data(), key_data.size(), key_data.data() });
+            }
+            return batch;
+        };
+        std::vector<size_t> skewed(1020, 256);
+        skewed.insert(skewed.end(), 4, 1024 * KiB);
+
+        const std::pair<const char*, std::vector<catalyst::input_data>> batches[] = {
+            { "1024 x 4 KiB", make_batch(std::vector<size_t>(1024, 4 * KiB)) },
+            { "1020 x 256 B + 4 x 1 MiB", make_batch(skewed) }
+        };
+
+        out.table("threads", "encrypt_serial_mt", { "batch", "threads", "messages/s", "MB/s" });
+
+        for (const auto& [name, batch] : batches) {
+            uint64_t bytes = 0;
+            for (const catalyst::input_data& d : batch) {
+                bytes += d.data_length;
+            }
+
+            for (size_t threads : thread_counts) {
+                catalyst::set_concurrency(threads);
+                const measurement m = measure([&]() {
+                    sink = catalyst::encrypt_serial_mt(batch).size();
+                });
+
+                out.add({
+                    { "batch", name },
+                    { "threads", (uint64_t)threads },
+                    { "messages/s", batch.size() / m.seconds },
+                    { "MB/s", bytes / m.seconds / 1e6 },
+                    { "ns/call", m.seconds * 1e9 }
+                });
+            }
+        }
+
+        catalyst::set_concurrency(0);
+    }
+
+    std::string to_hex(std::span<const uint8_t> data) {
+        std::string hex;
+        for (uint8_t b : data) {
+            char digits[3];
+            snprintf(digits, sizeof(digits), "%02x", b);
+            hex += digits;
+        }
+        return hex;
+    }
+
+    // --verify: the fused pipeline against the staged reference path, then ciphers of the deterministic seed mode
+    // against golden digests, every mismatch is printed and counted
+    size_t verify() {
+        // same extension for both paths: the DRBG is reseeded before each encryption
+        const std::vector<uint8_t> seed = pattern(32, 3);
+        size_t failures = 0;
+        size_t checks = 0;
+
+        const auto check = [&](bool ok, const std::string& what) {
+            ++checks;
+            if (!ok) {
+                ++failures;
+                fprintf(stderr, "verify: %s\n", what.c_str());
+            }
+        };
+
+        constexpr size_t tile = catalyst::Fused::tile_size;
+        constexpr size_t max_rounds = catalyst::SBox::max_rounds;
+
+        // up to max_rounds + 1 bytes the stage 3 rotation wraps around the message (rot = s3_rounds % n),
+        // then the tile edges with the rotated bytes straddling them
+        std::vector<size_t> lengths;
+        for (size_t n = 0; n <= max_rounds + 1; ++n) {
+            lengths.push_back(n);
+        }
+        for (size_t edge : { tile, 2 * tile, 3 * tile }) {
+            for (size_t n : { edge - max_rounds, edge - 1, edge, edge + 1, edge + max_rounds }) {
+                lengths.push_back(n);
+            }
+        }
+        lengths.push_back(100000);
+
+        // short keys, and a key over 256 bytes whose stage 3 transform is hashed from it
+        for (size_t key_length : { 1, 32, 64, 300 }) {
+            std::vector<uint8_t> key_data = pattern(key_length, 11);
+            const catalyst::key_context key(key_data.data(), key_data.size());
+            const catalyst::key_schedule& schedule = key.schedule();
+
+            for (size_t length : lengths) {
+                const std::string name = format_size(key_length) + " key, " + std::to_string(length) + " B";
+                const std::vector<uint8_t> plain = pattern(length);
+                const size_t size = catalyst::max_cipher_size(length);
+
+                std::vector<uint8_t> staged(size);
+                catalyst::set_random_seed(seed);
+                staged.resize(catalyst::Staged::encrypt(plain, staged, schedule));
+
+                std::vector<uint8_t> fused(size);
+                catalyst::set_random_seed(seed);
+                fused.resize(catalyst::Fused::encrypt(plain, fused, schedule));
+                check(fused == staged, name + ": fused encrypt differs from staged");
+
+                // the plain data at the start of the cipher buffer
+                std::vector<uint8_t> in_place(size);
+                std::copy(plain.begin(), plain.end(), in_place.begin());
+                catalyst::set_random_seed(seed);
+                in_place.resize(catalyst::Fused::encrypt(std::span<const uint8_t>(in_place.data(), length), in_place, schedule));
+                check(in_place == staged, name + ": in place fused encrypt differs from staged");
+
+                std::vector<uint8_t> decrypted(staged.size());
+                decrypted.resize(catalyst::Fused::decrypt(staged, decrypted, schedule));
+                check(decrypted == plain, name + ": fused decrypt differs from the plain data");
+
+                in_place = staged;
+                in_place.resize(catalyst::Fused::decrypt(in_place, in_place, schedule));
+                check(in_place == plain, name + ": in place fused decrypt differs from the plain data");
+
+                decrypted.assign(staged.size(), 0);
+                decrypted.resize(catalyst::Staged::decrypt(staged, decrypted, schedule));
+                check(decrypted == plain, name + ": staged decrypt differs from the plain data");
+            }
+        }
+
+        // SHA3-256 of the cipher of pattern(plain length) under pattern(key length, 11), seeded with pattern(32, 3),
+        // any change to the cipher format shows up here (these ciphers decrypt with the code before the fused path)
+        struct golden {
+            size_t key_length;
+            size_t plain_length;
+            const char* digest;
+        };
+        const golden vectors[] = {
+            { 32, 16, "e552561b60a540a695d7ff9d60e091b9e204c394100507b8f1ec579ba221b9ee" },
+            { 5, 1000, "b180bd97d69f8a751fffaccd3d8d9ce4a9d6f98c10377fc535840642a6b17e7d" },
+            { 64, tile + 1, "a970dbed635990fb69c902db4f5a30ae551ba96eb7200577641b20b263bd75f9" },
+            { 300, 2 * tile + max_rounds, "8432cf3ebcd4d569d5d631c0e9e280d9fe2491da60b350faf85819feb6e1cbf6" }
+        };
+
+        for (const golden& v : vectors) {
+            std::vector<uint8_t> key_data = pattern(v.key_length, 11);
+            const catalyst::key_context key(key_data.data(), key_data.size());
+            const std::vector<uint8_t> plain = pattern(v.plain_length);
+
+            std::vector<uint8_t> cipher(catalyst::max_cipher_size(plain.size()));
+            catalyst::set_random_seed(seed);
+            cipher.resize(catalyst::encrypt(plain, cipher, key));
+
+            uint8_t digest[32];
+            SHA3::SHA3_256(cipher.data(), cipher.size(), digest);
+            const std::string hex = to_hex(digest);
+            check(hex == v.digest, format_size(v.key_length) + " key, " + std::to_string(v.plain_length) + " B: golden cipher digest " + hex + ", expected " + v.digest);
+        }
+
+        catalyst::set_random_source({});
+
+        printf("verify: %zu checks, %zu failed\n", checks, failures);
+        return failures;
+    }
+
+    [[noreturn]] void print_usage() {
+        fprintf(stderr, "Usage: catalyst_bench [constants|keccak|sbox|sigma|stages|pipeline|keys|threads] [--max-size <bytes>] [--json]\n"
+            "       catalyst_bench --verify\n");
+        std::exit(-1);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const std::string suites[] = { "keccak", "constants", "sbox", "sigma", "stages", "pipeline", "keys", "threads" };
+    std::string suite = "all";
+    uint64_t max_size = GiB;
+    bool json = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+
+        if (arg == "--verify") {
+            return verify() == 0 ? 0 : 1;
+        }
+        else if (arg == "--max-size" && i + 1 < argc) {
+            max_size = std::stoull(argv[++i]);
+        }
+        else if (arg == "--json") {
+            json = true;
+        }
+        else if (std::find(std::begin(suites), std::end(suites), arg) != std::end(suites)) {
+            suite = arg;
+        }
+        else {
+            print_usage();
+        }
+    }
+
+    report out(json);
+
+    if (suite == "all" || suite == "keccak") {
+        bench_keccak(out, max_size);
+    }
+    if (suite == "all" || suite == "constants") {
+        bench_constants(out, max_size);
+    }
+    if (suite == "all" || suite == "sbox") {
+        bench_sbox(out);
+    }
+    if (suite == "all" || suite == "sigma") {
+        bench_sigma(out);
+    }
+    if (suite == "all" || suite == "stages") {
+        bench_stages(out, max_size);
+    }
+    if (suite == "all" || suite == "pipeline") {
+        bench_pipeline(out, max_size);
+    }
+    if (suite == "all" || suite == "keys") {
+        bench_keys(out);
+    }
+    if (suite == "all" || suite == "threads") {
+        bench_threads(out);
+    }
+
+    out.finish();
+    return 0;
+}
\ No newline at end of file
@@ -1,88 +1,174 @@
-#include <iostream>
-#include <filesystem>
-#include <fstream>
-#include <unordered_set>
-#include <vector>
-
-#include "catalyst.hpp"
-#include "commandline_args.hpp"
-
-inline void print_vector(const std::vector<uint8_t>& data) {    
-    printf("\t(string) ");
-    for (const auto& e : data) {
-        printf("%c", (char)e);
-    }
-    printf("\n");
-    
-    printf("\t(hexadecimal) 0x");
-    for (const auto& e : data) {
-        printf("%02x", (uint16_t)e);
-    }
-    printf("\n");
-}
-
-int main(int argc, char* argv[]) {
-    _execution_context ectx = process_arguments(argc, argv);
-
-    const std::string& data = ectx.data;
-    const std::string& key = ectx.key;
-
-    std::cout << "\n";
-    std::cout << "provided key:\n";
-    print_vector(std::vector<uint8_t>((uint8_t*)key.data(), (uint8_t*)key.data() + key.size()));
-    std::cout << std::endl;
-
-    if (ectx.mode == _internal_mode::encryption) {
-        std::cout << "mode: encryption\n\n";
-        std::cout << "input data:\n";
-        
-        std::vector<uint8_t> raw_data((uint8_t*)data.data(), (uint8_t*)data.data() + data.size());
-
-        print_vector(raw_data);
-        std::cout << std::endl;
-        
-        std::vector<uint8_t> cipher = catalyst::encrypt(raw_data.data(), raw_data.size(), (uint8_t*)key.data(), key.size());
-        std::cout << "output cipher:\n";
-        if (!ectx.output_to_file) {
-            print_vector(cipher);
-        }
-        else {
-            std::ofstream output_f(ectx.output_file_name, std::ios::binary);
-            if (output_f) {
-                output_f.write((char*)cipher.data(), cipher.size() / sizeof(char));
-                std::cout << "Output written to file: " << ectx.output_file_name << std::endl;
-            }
-            else {
-                std::cerr << "Unable to write output to file: " << ectx.output_file_name << std::endl;
-                return -1;
-            }
-        }
-    } else if (ectx.mode == _internal_mode::decryption) {
-        std::cout << "mode: decryption\n\n";
-        std::cout << "input data:\n";
-
-        std::vector<uint8_t> raw_data((uint8_t*)data.data(), (uint8_t*)data.data() + data.size());
-
-        print_vector(raw_data);
-        std::cout << std::endl;
-
-        std::vector<uint8_t> recovered = catalyst::decrypt((uint8_t*)data.data(), data.size(), (uint8_t*)key.data(), key.size());
-        std::cout << "recovered data:\n";
-        if (!ectx.output_to_file) {
-            print_vector(recovered);
-        }
-        else {
-            std::ofstream output_f(ectx.output_file_name, std::ios::binary);
-            if (output_f) {
-                output_f.write((char*)recovered.data(), recovered.size() / sizeof(char));
-                std::cout << "Output written to file: " << ectx.output_file_name << std::endl;
-            }
-            else {
-                std::cerr << "Unable to write output to file: " << ectx.output_file_name << std::endl;
-                return -1;
-            }
-        }
-    }
-
-    return 0;
-}
\ No newline at end of file
+#include <iostream>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+#include "catalyst.hpp"
+#include "batch.hpp"
+#include "commandline_args.hpp"
+#include "file_io.hpp"
+
+inline void print_vector(std::span<const uint8_t> data) {
+    printf("\t(string) ");
+    for (const auto& e : data) {
+        printf("%c", (char)e);
+    }
+    printf("\n");
+    
+    printf("\t(hexadecimal) 0x");
+    for (const auto& e : data) {
+        printf("%02x", (uint16_t)e);
+    }
+    printf("\n");
+}
+
+// encrypts / decrypts <input> straight into the output file: a mapping of the largest possible output
+// cut down to the actual size, or a single write of the framed format
+static void process_file(const _execution_context& ectx, std::span<const uint8_t> input, const catalyst::key_context& key) {
+    const bool encryption = ectx.mode == _internal_mode::encryption;
+
+    if (ectx.parallel) {
+        const std::vector<uint8_t> output = encryption ? catalyst::encrypt_parallel(input, key) : catalyst::decrypt_parallel(input, key);
+        write_file(ectx.output_file_name, output);
+    }
+    else if (encryption) {
+        output_file output(ectx.output_file_name, catalyst::max_cipher_size(input.size()));
+        output.commit(catalyst::encrypt(input, output.data(), key));
+    }
+    else {
+        output_file output(ectx.output_file_name, input.size());
+        output.commit(catalyst::decrypt(input, output.data(), key));
+    }
+}
+
+// stdin to stdout through the framed format, a chunk at a time: memory use does not depend on the data size
+static void process_stream(const _execution_context& ectx, const catalyst::key_context& key) {
+    std::vector<uint8_t> buffer(catalyst::default_chunk_size);
+    const catalyst::output_sink sink = [](std::span<const uint8_t> output) {
+        write_stdout(output);
+    };
+
+    const auto run = [&](auto& processor) {
+        for (;;) {
+            const size_t n = read_stdin(buffer);
+            processor.update(std::span<const uint8_t>(buffer).first(n));
+            if (n < buffer.size()) {
+                break;
+            }
+        }
+        processor.finish();
+    };
+
+    if (ectx.mode == _internal_mode::encryption) {
+        catalyst::encryptor encryptor(key, sink);
+        run(encryptor);
+    }
+    else {
+        catalyst::decryptor decryptor(key, sink);
+        run(decryptor);
+    }
+
+    if (std::fflush(stdout) != 0) {
+        throw std::runtime_error("Unable to write to the standard output");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // usage errors, a key file or descriptor that cannot be read and threads that cannot be started
+    _execution_context ectx;
+    try {
+        ectx = process_arguments(argc, argv);
+
+        if (ectx.parallel) {
+            catalyst::set_concurrency(ectx.threads);
+            // starts the threads now rather than on first use, where a failure would not be reported the same way
+            catalyst::concurrency();
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return -1;
+    }
+
+    const std::string& key = ectx.key;
+    if (ectx.batch) {
+        return run_batch(ectx);
+    }
+    if (ectx.streaming) {
+        try {
+            process_stream(ectx, catalyst::key_context((uint8_t*)key.data(), key.size()));
+        }
+        catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+        return 0;
+    }
+
+    // files are read through a mapping and nothing is printed about them unless -v is given
+    std::optional<input_file> file;
+    std::span<const uint8_t> data((const uint8_t*)ectx.data.data(), ectx.data.size());
+    if (ectx.output_to_file) {
+        try {
+            file.emplace(ectx.input_file_name);
+        }
+        catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+        data = file->data();
+    }
+    const bool verbose = !ectx.output_to_file || ectx.verbose;
+    const bool encryption = ectx.mode == _internal_mode::encryption;
+
+    if (verbose) {
+        std::cout << "\n";
+        std::cout << "provided key:\n";
+        print_vector(std::span<const uint8_t>((const uint8_t*)key.data(), key.size()));
+        std::cout << std::endl;
+
+        std::cout << (encryption ? "mode: encryption\n\n" : "mode: decryption\n\n");
+        std::cout << "input data:\n";
+        print_vector(data);
+        std::cout << std::endl;
+    }
+
+    if (ectx.output_to_file) {
+        try {
+            process_file(ectx, data, catalyst::key_context((uint8_t*)key.data(), key.size()));
+        }
+        catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+
+        if (verbose) {
+            std::cout << (encryption ? "output cipher:\n" : "recovered data:\n");
+            std::cout << "Output written to file: " << ectx.output_file_name << std::endl;
+        }
+        return 0;
+    }
+
+    std::vector<uint8_t> raw_data(data.begin(), data.end());
+
+    if (encryption) {
+        std::vector<uint8_t> cipher = ectx.parallel
+            ? catalyst::encrypt_parallel(raw_data, catalyst::key_context((uint8_t*)key.data(), key.size()))
+            : catalyst::encrypt(raw_data.data(), raw_data.size(), (uint8_t*)key.data(), key.size());
+        std::cout << "output cipher:\n";
+        print_vector(cipher);
+    } else {
+        std::vector<uint8_t> recovered = ectx.parallel
+            ? catalyst::decrypt_parallel(raw_data, catalyst::key_context((uint8_t*)key.data(), key.size()))
+            : catalyst::decrypt(raw_data.data(), raw_data.size(), (uint8_t*)key.data(), key.size());
+        std::cout << "recovered data:\n";
+        print_vector(recovered);
+    }
+
+    return 0;
+}
@@ -1,37 +1,261 @@
-#pragma once
-
-#include <iostream>
-#include <cmath>
-#include <cstdint>
-#include <array>
-#include <vector>
-
-namespace catalyst {
-    struct input_data {
-        size_t data_length;
-        uint8_t* data;
-        size_t key_length;
-        uint8_t* key;
-    };
-    
-    // encrypts <plain_data> of length <plain_length> into a cipher of random length (>= plain_length),
-    // using <key_data> of length <key_length>
-    std::vector<uint8_t> encrypt(uint8_t plain_data[], size_t plain_length, uint8_t key_data[], size_t key_length);
-    // decrypts <plain_data> of length <plain_length> into a cipher of random length (>= plain_length),
-    // using <key_data> of length <key_length>
-    std::vector<uint8_t> decrypt(uint8_t cipher_data[], size_t cipher_length, uint8_t key_data[], size_t key_length);
-    // encrypts data according to the data stored in the struct <data>
-    std::vector<uint8_t> encrypt(const input_data& data);
-    // decrypts data according to the data stored in the struct <data>
-    std::vector<uint8_t> decrypt(const input_data& data);
-
-    // encrypts a vector of data, iteratively calling catalyst::encrypt(data_v[i])
-    std::vector<std::vector<uint8_t>> encrypt_serial(const std::vector<input_data>& data_v);
-    // decrypts a vector of data, iteratively calling catalyst::decrypt(data_v[i])
-    std::vector<std::vector<uint8_t>> decrypt_serial(const std::vector<input_data>& data_v);
-
-    // multithreaded equivalent of catalyst::encrypt_serial, n_block is the number of iterations done each thread
-    std::vector<std::vector<uint8_t>> encrypt_serial_mt(const std::vector<input_data>& data_v, const size_t n_block = 1);
-    // multithreaded equivalent of catalyst::decrypt_serial, n_block is the number of iterations done each thread
-    std::vector<std::vector<uint8_t>> decrypt_serial_mt(const std::vector<input_data>& data_v, const size_t n_block = 1);
-}
\ No newline at end of file
+#pragma once
+
+#include <iostream>
+#include <cmath>
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace catalyst {
+    struct key_schedule;
+
+    struct input_data {
+        size_t data_length;
+        uint8_t* data;
+        size_t key_length;
+        uint8_t* key;
+    };
+
+    // key schedule computed once from <key_data> of length <key_length>, immutable once built,
+    // copies are cheap and may be shared between threads
+    class key_context {
+    public:
+        key_context(uint8_t key_data[], size_t key_length);
+        // a schedule already computed, by catalyst::get_key_schedule
+        explicit key_context(std::shared_ptr<const key_schedule> schedule);
+
+        const key_schedule& schedule() const;
+    private:
+        std::shared_ptr<const key_schedule> _schedule;
+    };
+    
+    // encrypts <plain_data> of length <plain_length> into a cipher of random length (>= plain_length),
+    // using <key_data> of length <key_length>
+    std::vector<uint8_t> encrypt(uint8_t plain_data[], size_t plain_length, uint8_t key_data[], size_t key_length);
+    // decrypts <plain_data> of length <plain_length> into a cipher of random length (>= plain_length),
+    // using <key_data> of length <key_length>
+    std::vector<uint8_t> decrypt(uint8_t cipher_data[], size_t cipher_length, uint8_t key_data[], size_t key_length);
+    // encrypts data according to the data stored in the struct <data>
+    std::vector<uint8_t> encrypt(const input_data& data);
+    // decrypts data according to the data stored in the struct <data>
+    std::vector<uint8_t> decrypt(const input_data& data);
+    // encrypts <plain_data> of length <plain_length> using the precomputed key schedule <key>,
+    // same output as catalyst::encrypt called with the key <key> was built from
+    std::vector<uint8_t> encrypt(const uint8_t plain_data[], size_t plain_length, const key_context& key);
+    // decrypts <cipher_data> of length <cipher_length> using the precomputed key schedule <key>
+    std::vector<uint8_t> decrypt(const uint8_t cipher_data[], size_t cipher_length, const key_context& key);
+
+    // stage 4 appends at most 255 random bytes plus their count
+    constexpr size_t max_extension_size = 256;
+
+    // size of the output buffer catalyst::encrypt needs for <plain_length> bytes of plain data
+    constexpr size_t max_cipher_size(size_t plain_length) {
+        return plain_length + max_extension_size;
+    }
+
+    // encrypts <plain> into the start of <cipher> without any intermediate copy, <cipher> must hold at least
+    // max_cipher_size(plain.size()) bytes and may start at the same address as <plain>, returns the cipher length
+    size_t encrypt(std::span<const uint8_t> plain, std::span<uint8_t> cipher, const key_context& key);
+    // decrypts <cipher> into the start of <plain>, which must hold at least cipher.size() bytes and may start
+    // at the same address as <cipher>, returns the plain data length, throws std::runtime_error on malformed input
+    size_t decrypt(std::span<const uint8_t> cipher, std::span<uint8_t> plain, const key_context& key);
+    // decrypts <data> in place, the plain data is left at its start, returns its length
+    size_t decrypt(std::span<uint8_t> data, const key_context& key);
+
+    // fills <out> with <n> random bytes, may be called from several threads at once
+    typedef std::function<void(uint8_t* out, size_t n)> random_source;
+
+    // replaces the source of the random stage 4 extension, an empty function restores the default one:
+    // a SHAKE256 DRBG per thread, seeded by the OS, reseeded every MiB of output and after a fork
+    void set_random_source(random_source source);
+    // deterministic mode for benchmarks and test vectors: every extension is drawn from one SHAKE256 DRBG
+    // seeded with <seed>, so the same sequence of calls gives the same ciphers (never use it on real data)
+    void set_random_seed(std::span<const uint8_t> seed);
+
+    // encrypts a vector of data, iteratively calling catalyst::encrypt(data_v[i])
+    std::vector<std::vector<uint8_t>> encrypt_serial(const std::vector<input_data>& data_v);
+    // decrypts a vector of data, iteratively calling catalyst::decrypt(data_v[i])
+    std::vector<std::vector<uint8_t>> decrypt_serial(const std::vector<input_data>& data_v);
+
+    // number of threads used by the multithreaded functions, 0 restores the default: the CPUs available to the
+    // process, capped by its cgroup CPU quota; at most 8 times the default are started, on first use, and kept until
+    // the next change (std::system_error when the system cannot start them)
+    void set_concurrency(size_t threads);
+    size_t concurrency();
+
+    // multithreaded equivalent of catalyst::encrypt_serial, run on the catalyst::concurrency() threads with the
+    // batch split by byte volume (<n_block> is ignored, kept for source compatibility)
+    std::vector<std::vector<uint8_t>> encrypt_serial_mt(const std::vector<input_data>& data_v, const size_t n_block = 1);
+    // multithreaded equivalent of catalyst::decrypt_serial, see catalyst::encrypt_serial_mt
+    std::vector<std::vector<uint8_t>> decrypt_serial_mt(const std::vector<input_data>& data_v, const size_t n_block = 1);
+    // catalyst::encrypt_serial_mt for messages that all use the key schedule <key>, computed once
+    std::vector<std::vector<uint8_t>> encrypt_serial_mt(const std::vector<std::span<const uint8_t>>& data_v, const key_context& key);
+    // catalyst::decrypt_serial_mt for ciphers that all use the key schedule <key>, throws std::runtime_error
+    // (the first one raised) when any of them is malformed
+    std::vector<std::vector<uint8_t>> decrypt_serial_mt(const std::vector<std::span<const uint8_t>>& data_v, const key_context& key);
+
+    // error of an asynchronous request cancelled before it started
+    class request_cancelled : public std::runtime_error {
+    public:
+        request_cancelled();
+    };
+    // error of an asynchronous request still queued when its deadline passed
+    class deadline_exceeded : public std::runtime_error {
+    public:
+        deadline_exceeded();
+    };
+
+    // cancels the asynchronous requests it is passed to, copies share the same state
+    class cancellation_token {
+    public:
+        cancellation_token();
+
+        void cancel();
+        bool cancelled() const;
+    private:
+        std::shared_ptr<std::atomic<bool>> _cancelled;
+    };
+
+    struct async_options {
+        // a request that has not started by then fails with catalyst::deadline_exceeded
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+        // a request that has not started when the token is cancelled fails with catalyst::request_cancelled
+        std::optional<cancellation_token> token;
+    };
+
+    // called once per request with its output, or with the exception it failed with (the output is then empty),
+    // from one of the catalyst::concurrency() threads, must not throw
+    typedef std::function<void(std::vector<uint8_t> output, std::exception_ptr error)> completion_callback;
+
+    // queues the encryption of <data> and returns immediately, the requests queued while every thread has a batch
+    // are coalesced into the next one, run on the catalyst::concurrency() threads like catalyst::encrypt_serial_mt;
+    // the buffers <data> points to must stay valid until the request completes
+    std::future<std::vector<uint8_t>> encrypt_async(const input_data& data, const async_options& options = {});
+    void encrypt_async(const input_data& data, completion_callback done, const async_options& options = {});
+    // asynchronous equivalent of catalyst::decrypt(data), see catalyst::encrypt_async
+    std::future<std::vector<uint8_t>> decrypt_async(const input_data& data, const async_options& options = {});
+    void decrypt_async(const input_data& data, completion_callback done, const async_options& options = {});
+
+    // receives the output of catalyst::encryptor / catalyst::decryptor as it is produced
+    typedef std::function<void(std::span<const uint8_t>)> output_sink;
+
+    // plaintext bytes per frame of the streaming format
+    constexpr size_t default_chunk_size = 1 << 20;
+
+    // encrypts data of any size, fed piece by piece, into the framed streaming format: the plaintext is cut into
+    // <chunk_size> frames, each one encrypted with its own key derived from <key>, and the output is handed
+    // to <sink> frame by frame, memory use only depends on <chunk_size>
+    // (the output of the streaming format can only be read back by catalyst::decryptor)
+    class encryptor {
+    public:
+        encryptor(const key_context& key, output_sink sink, size_t chunk_size = default_chunk_size);
+
+        void update(std::span<const uint8_t> data);
+        // encrypts the last (possibly empty) frame, no data can be added afterwards
+        void finish();
+    private:
+        void write_frame(std::span<const uint8_t> chunk, bool final);
+
+        key_context _key;
+        output_sink _sink;
+        size_t _chunk_size;
+        uint64_t _frame = 0;
+        std::vector<uint8_t> _pending;
+        bool _finished = false;
+    };
+
+    // decrypts the framed streaming format written by catalyst::encryptor, fed piece by piece,
+    // recovered data is handed to <sink> frame by frame, throws std::runtime_error on malformed input
+    class decryptor {
+    public:
+        decryptor(const key_context& key, output_sink sink);
+
+        void update(std::span<const uint8_t> data);
+        // checks that the final frame has been received
+        void finish();
+    private:
+        key_context _key;
+        output_sink _sink;
+        size_t _chunk_size = 0;
+        uint64_t _frame = 0;
+        std::vector<uint8_t> _pending;
+        bool _header_read = false;
+        bool _final_read = false;
+    };
+
+    // encrypts <data> into the framed streaming format (same output as catalyst::encryptor), frames are
+    // encrypted independently on up to <threads> of the catalyst::concurrency() threads (0: all of them)
+    std::vector<uint8_t> encrypt_parallel(std::span<const uint8_t> data, const key_context& key, size_t threads = 0, size_t chunk_size = default_chunk_size);
+    // decrypts the framed streaming format (catalyst::encryptor or catalyst::encrypt_parallel output) on up to <threads> threads,
+    // throws std::runtime_error on malformed input
+    std::vector<uint8_t> decrypt_parallel(std::span<const uint8_t> data, const key_context& key, size_t threads = 0);
+}
+namespace catalyst::stats {
+    // what the time is spent on: the key schedule and its components, every stage and its inverse (stage 5 is its
+    // own inverse) and the streams behind them; nested counters overlap, e.g. key_schedule includes every key_
+    // counter and stage5 includes the xor_keystream blocks generated on a cache miss
+    enum class counter : size_t {
+        encrypt,
+        decrypt,
+        key_schedule,
+        key_constants,
+        key_sigma,
+        key_rounds,
+        key_sbox,
+        key_transform,
+        stage1,
+        Istage1,
+        stage2,
+        Istage2,
+        stage3,
+        Istage3,
+        stage4,
+        Istage4,
+        stage5,
+        extend_constants,
+        xor_keystream,
+        random,
+        count
+    };
+
+    struct values {
+        uint64_t calls = 0;
+        uint64_t bytes = 0;
+        uint64_t nanoseconds = 0;
+        // SHA3 / SHAKE invocations
+        uint64_t hashes = 0;
+    };
+
+    struct snapshot {
+        std::array<values, (size_t)counter::count> counters;
+
+        const values& operator[](counter c) const {
+            return counters[(size_t)c];
+        }
+    };
+
+    // false when the library was built without the counters (-DCATALYST_STATS=OFF), every other
+    // function then does nothing and catalyst::stats::read returns zeros
+    bool available();
+
+    // the counters are off until enabled, they then cost two clock reads per counted call
+    void enable(bool on);
+    bool enabled();
+
+    // sum of the counters of every thread (including the threads that have exited) since the last reset,
+    // may be called at any time from any thread
+    snapshot read();
+    void reset();
+
+    // name of <c> as spelled in the enumeration
+    const char* name(counter c);
+}
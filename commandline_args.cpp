@@ -1,122 +1,198 @@
-#include <iostream>
-#include <filesystem>
-#include <fstream>
-#include <string>
-#include <unordered_set>
-#include <vector>
-
-#include "commandline_args.hpp"
-
-namespace {
-    static const std::unordered_set<std::string> valid_modes = {
-        "-e", "-ex", "-ef", "-exf",
-        "-d", "-dx", "-df", "dxf"
-    };
-    static const std::vector<std::pair<std::string, std::string>> modes_help = {
-        { "-e  ",   "encrypts data with specified key, data and key are both strings" },
-        { "-ex ",  "encrypts data with specified key, data and key are both in hexadecimal" },
-        { "-ef ",  "encrypts file with specified key, data is the name of the file to encrypt, key is a string" },
-        { "-exf", "encrypts file with specified key, data is the name of the file to encrypt, key in hexadecimal" },
-        
-        { "-d  ",   "decrypts data with specified key, data and key are both strings" },
-        { "-dx ",  "decrypts data with specified key, data and key are both in hexadecimal" },
-        { "-df ",  "decrypts file with specified key, data is the name of the file to decrypt, key is a string" },
-        { "-dxf", "decrypts file with specified key, data is the name of the file to decrypt, key in hexadecimal" }
-    };
-    [[noreturn]] static void print_usage() {
-        static const std::string str = "\nUsage: catalyst <-e[x][f]|-d[x][f]> <data> <key>\n";
-        std::string msg = str;
-        for (const auto& m : modes_help) {
-            msg += m.first + ":" + m.second + "\n";
-        }
-        throw std::runtime_error(msg);
-    }
-
-    static std::string parse_hex(const std::string& s) {
-        std::string parsed = "";
-        char temp[3] = { 0 };
-        char* temp_end = nullptr;
-
-        for (size_t i = 2; i < s.size(); i += 2) {
-            temp[0] = s[i];
-            temp[1] = s[i + 1];
-            char c = (char)(uint8_t)std::strtoul(temp, &temp_end, 16);
-            parsed += c;
-        }
-
-        return parsed;
-    }
-    static std::string read_file(const std::string filename) {
-        std::string read = "";
-
-        const size_t filesize = std::filesystem::file_size(filename);
-        std::ifstream input_data_file(filename, std::ios::binary);
-
-        if (input_data_file) {
-            read.resize(filesize);
-            input_data_file.read((char*)read.data(), filesize);
-            return read;
-        }
-        else {
-            throw std::runtime_error("Unable to read file: " + filename);
-        }
-    }
-}
-
-_execution_context process_arguments(int argc, char** argv) {
-    if (argc < 2) {
-        print_usage();
-    }
-
-    _execution_context ectx;
-
-    std::string mode = argv[1];
-    if (!valid_modes.contains(mode)) {
-        print_usage();
-    }
-    mode = mode.substr(1);
-
-    if (argc != 4) {
-        print_usage();
-    }
-
-    if (mode.ends_with("x")) {
-        mode = mode.substr(0, mode.size() - 1);
-        std::string _data = argv[2];
-        std::string _key = argv[3];
-
-        ectx.data = parse_hex(_data);
-        ectx.key = parse_hex(_key);
-    }
-    else if (mode.ends_with("f")) {
-        mode = mode.substr(0, mode.size() - 1);
-        ectx.output_to_file = true;
-
-        auto output_path = std::filesystem::path(argv[2]);
-        output_path.replace_extension(".out");
-        ectx.output_file_name = output_path.string();
-        
-        ectx.data = read_file(argv[2]);
-        
-        if (mode.ends_with("x")) {
-            mode = mode.substr(0, mode.size() - 1);
-            ectx.key = parse_hex(argv[3]);
-        }
-        else {
-            ectx.key = argv[3];
-        }
-    }
-    else {
-        ectx.data = argv[2];
-        ectx.key = argv[3];
-    }
-
-    if (mode == "e") {
-        ectx.mode = _internal_mode::encryption;
-    }
-    else {
-        ectx.mode = _internal_mode::decryption;
-    }
-
-    return ectx;
+#include <iostream>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "commandline_args.hpp"
+#include "file_io.hpp"
+
+namespace {
+    static const std::unordered_set<std::string> valid_modes = {
+        "-e", "-ex", "-ef", "-exf",
+        "-d", "-dx", "-df", "-dxf"
+    };
+    static const std::vector<std::pair<std::string, std::string>> modes_help = {
+        { "-e  ",   "encrypts data with specified key, data and key are both strings" },
+        { "-ex ",  "encrypts data with specified key, data and key are both in hexadecimal" },
+        { "-ef ",  "encrypts file with specified key, data is the name of the file to encrypt, key is a string" },
+        { "-exf", "encrypts file with specified key, data is the name of the file to encrypt, key in hexadecimal" },
+        
+        { "-d  ",   "decrypts data with specified key, data and key are both strings" },
+        { "-dx ",  "decrypts data with specified key, data and key are both in hexadecimal" },
+        { "-df ",  "decrypts file with specified key, data is the name of the file to decrypt, key is a string" },
+        { "-dxf", "decrypts file with specified key, data is the name of the file to decrypt, key in hexadecimal" }
+    };
+    static const std::vector<std::pair<std::string, std::string>> options_help = {
+        { "-p <threads>", "uses the framed format, whose frames are encrypted/decrypted in parallel on <threads> threads (0: all the CPUs available to the process)" },
+        { "-v", "file modes: prints the key, the input data and the output file name (file modes are otherwise silent)" },
+        { "--batch", "file modes: data is a directory (every file in it, recursively) or a file listing one file name per line, all of them are processed in parallel with the same key" },
+        { "--key-file <file>", "reads the key from <file> (in hexadecimal for the x modes) instead of the <key> argument" },
+        { "--key-fd <fd>", "reads the key from the file descriptor <fd> until its end (in hexadecimal for the x modes) instead of the <key> argument" }
+    };
+    [[noreturn]] static void print_usage() {
+        static const std::string str = "\nUsage: catalyst <-e[x][f]|-d[x][f]> [options] <data|-> <key>\n"
+            "(- reads the data from stdin and writes the output to stdout, in the framed format, a frame at a time)\n";
+        std::string msg = str;
+        for (const auto& m : modes_help) {
+            msg += m.first + ":" + m.second + "\n";
+        }
+        msg += "options:\n";
+        for (const auto& o : options_help) {
+            msg += o.first + ":" + o.second + "\n";
+        }
+        throw std::runtime_error(msg);
+    }
+
+    static std::string parse_hex(const std::string& s) {
+        std::string parsed = "";
+        char temp[3] = { 0 };
+        char* temp_end = nullptr;
+
+        for (size_t i = 2; i < s.size(); i += 2) {
+            temp[0] = s[i];
+            temp[1] = s[i + 1];
+            char c = (char)(uint8_t)std::strtoul(temp, &temp_end, 16);
+            parsed += c;
+        }
+
+        return parsed;
+    }
+
+    // key from a file or a file descriptor, the x modes take it in hexadecimal, surrounding whitespace ignored
+    static std::string read_key(const std::string& source, bool from_fd, bool hex) {
+        std::vector<uint8_t> raw;
+        if (from_fd) {
+            int fd = -1;
+            const auto [end, error] = std::from_chars(source.data(), source.data() + source.size(), fd);
+            if (error != std::errc() || end != source.data() + source.size() || fd < 0) {
+                throw std::runtime_error("Invalid key descriptor: " + source);
+            }
+            raw = read_descriptor(fd);
+        }
+        else {
+            const input_file file(source);
+            raw.assign(file.data().begin(), file.data().end());
+        }
+        std::string key(raw.begin(), raw.end());
+
+        if (!hex) {
+            return key;
+        }
+
+        const size_t begin = key.find_first_not_of(" \t\r\n");
+        const size_t end = key.find_last_not_of(" \t\r\n");
+        key = begin == std::string::npos ? "" : key.substr(begin, end - begin + 1);
+        return parse_hex(key.starts_with("0x") ? key : "0x" + key);
+    }
+}
+
+_execution_context process_arguments(int argc, char** argv) {
+    if (argc < 2) {
+        print_usage();
+    }
+
+    _execution_context ectx;
+
+    std::string mode = argv[1];
+    if (!valid_modes.contains(mode)) {
+        print_usage();
+    }
+    mode = mode.substr(1);
+
+    const bool hex_key = mode.find('x') != std::string::npos;
+    std::string key_source;
+    bool key_from_fd = false;
+
+    std::vector<std::string> positional;
+    for (int i = 2; i < argc; ++i) {
+        const std::string arg = argv[i];
+
+        if (arg == "-p") {
+            // a whole non-negative number of threads must follow
+            if (i + 1 == argc) {
+                print_usage();
+            }
+            const std::string threads = argv[++i];
+            const auto [end, error] = std::from_chars(threads.data(), threads.data() + threads.size(), ectx.threads);
+            if (error != std::errc() || end != threads.data() + threads.size()) {
+                print_usage();
+            }
+            ectx.parallel = true;
+        }
+        else if (arg == "-v") {
+            ectx.verbose = true;
+        }
+        else if (arg == "--batch") {
+            ectx.batch = true;
+        }
+        else if ((arg == "--key-file" || arg == "--key-fd") && i + 1 < argc) {
+            key_source = argv[++i];
+            key_from_fd = arg == "--key-fd";
+        }
+        else {
+            positional.push_back(arg);
+        }
+    }
+
+    // the key read from a file takes the place of the <key> argument
+    if (!key_source.empty()) {
+        positional.push_back("");
+    }
+    if (positional.size() != 2 || (ectx.batch && (!mode.ends_with("f") || ectx.parallel || positional[0] == "-"))) {
+        print_usage();
+    }
+    ectx.streaming = positional[0] == "-";
+
+    if (mode.ends_with("x")) {
+        mode = mode.substr(0, mode.size() - 1);
+        std::string _data = positional[0];
+        std::string _key = positional[1];
+
+        ectx.data = parse_hex(_data);
+        ectx.key = parse_hex(_key);
+    }
+    else if (mode.ends_with("f")) {
+        mode = mode.substr(0, mode.size() - 1);
+        ectx.output_to_file = true;
+
+        auto output_path = std::filesystem::path(positional[0]);
+        output_path.replace_extension(".out");
+        ectx.output_file_name = output_path.string();
+        
+        ectx.input_file_name = positional[0];
+        
+        if (mode.ends_with("x")) {
+            mode = mode.substr(0, mode.size() - 1);
+            ectx.key = parse_hex(positional[1]);
+        }
+        else {
+            ectx.key = positional[1];
+        }
+    }
+    else {
+        ectx.data = positional[0];
+        ectx.key = positional[1];
+    }
+
+    if (!key_source.empty()) {
+        ectx.key = read_key(key_source, key_from_fd, hex_key);
+    }
+    if (ectx.streaming) {
+        // the data comes from stdin whatever the mode
+        ectx.data.clear();
+        ectx.output_to_file = false;
+    }
+
+    if (mode == "e") {
+        ectx.mode = _internal_mode::encryption;
+    }
+    else {
+        ectx.mode = _internal_mode::decryption;
+    }
+
+    return ectx;
 }
\ No newline at end of file
@@ -1,20 +1,31 @@
-#pragma once
-
-#include <iostream>
-#include <string>
-
-enum class _internal_mode {
-    encryption, // encrypts data
-    decryption, // decrypts data
-};
-
-struct _execution_context {
-    _internal_mode mode;
-    bool output_to_file = false;
-    std::string output_file_name;
-
-    std::string data;
-    std::string key;
-};
-
-_execution_context process_arguments(int argc, char** argv);
+#pragma once
+
+#include <iostream>
+#include <string>
+
+enum class _internal_mode {
+    encryption, // encrypts data
+    decryption, // decrypts data
+};
+
+struct _execution_context {
+    _internal_mode mode;
+    bool output_to_file = false;
+    std::string input_file_name;
+    std::string output_file_name;
+    // file modes print the key and the data, as the string modes do
+    bool verbose = false;
+    // file modes: input_file_name is a directory or a list of files, all of them processed with the same key
+    bool batch = false;
+    // data given as "-": read from stdin, written to stdout in the framed format, a frame at a time
+    bool streaming = false;
+
+    // framed format, encrypted/decrypted on <threads> threads (0: one per hardware thread)
+    bool parallel = false;
+    size_t threads = 0;
+
+    std::string data;
+    std::string key;
+};
+
+_execution_context process_arguments(int argc, char** argv);
@@ -0,0 +1,166 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "catalyst_internal.hpp"
+#include "../catalyst.hpp"
+
+// one dispatcher thread takes every queued request at once and hands them as a batch to the pool without waiting
+// for it, at most one batch per thread is in flight and the requests submitted meanwhile wait for the next one, so
+// many small concurrent requests cost a single pool job while a slow request only holds up the thread running it
+namespace {
+    struct request {
+        bool encrypt;
+        catalyst::input_data data;
+        catalyst::async_options options;
+        catalyst::completion_callback done;
+    };
+
+    struct batch {
+        std::vector<request> requests;
+        std::atomic<size_t> remaining = 0;
+    };
+
+    class dispatcher {
+    public:
+        dispatcher() : _thread([this]() { loop(); }) {}
+        // requests still queued at exit are cancelled, the batches handed to the pool run to completion
+        ~dispatcher() {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop = true;
+            }
+            _wake.notify_one();
+            _thread.join();
+        }
+
+        void submit(request&& r) {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _queue.push_back(std::move(r));
+            }
+            _wake.notify_one();
+        }
+    private:
+        void loop() {
+            for (;;) {
+                const std::shared_ptr<batch> b = std::make_shared<batch>();
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _wake.wait(lock, [&]() { return _stop || (!_queue.empty() && _running < catalyst::concurrency()); });
+                    if (_stop) {
+                        b->requests.swap(_queue);
+                        lock.unlock();
+
+                        for (auto& r : b->requests) {
+                            r.done({}, std::make_exception_ptr(catalyst::request_cancelled()));
+                        }
+
+                        lock.lock();
+                        _wake.wait(lock, [&]() { return _running == 0; });
+                        return;
+                    }
+                    b->requests.swap(_queue);
+                    b->remaining = b->requests.size();
+                    ++_running;
+                }
+
+                catalyst::Pool::post_messages(b->requests.size(), [&](size_t i) { return b->requests[i].data.data_length; }, [this, b](size_t i) {
+                    run(b->requests[i]);
+
+                    if (--b->remaining == 0) {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        --_running;
+                        _wake.notify_one();
+                    }
+                });
+            }
+        }
+
+        static void run(request& r) {
+            // checked once the request is picked up, a started request always runs to completion
+            std::exception_ptr error;
+            if (r.options.token && r.options.token->cancelled()) {
+                error = std::make_exception_ptr(catalyst::request_cancelled());
+            }
+            else if (std::chrono::steady_clock::now() >= r.options.deadline) {
+                error = std::make_exception_ptr(catalyst::deadline_exceeded());
+            }
+
+            std::vector<uint8_t> output;
+            if (!error) {
+                try {
+                    output = r.encrypt ? catalyst::encrypt(r.data) : catalyst::decrypt(r.data);
+                }
+                catch (...) {
+                    error = std::current_exception();
+                }
+            }
+
+            r.done(std::move(output), error);
+        }
+
+        std::mutex _mutex;
+        std::condition_variable _wake;
+        std::vector<request> _queue;
+        // batches handed to the pool and not done yet
+        size_t _running = 0;
+        bool _stop = false;
+        std::thread _thread;
+    };
+
+    dispatcher& get_dispatcher() {
+        static dispatcher d;
+        return d;
+    }
+
+    std::future<std::vector<uint8_t>> submit_future(bool encrypt, const catalyst::input_data& data, const catalyst::async_options& options) {
+        const auto promise = std::make_shared<std::promise<std::vector<uint8_t>>>();
+        std::future<std::vector<uint8_t>> result = promise->get_future();
+
+        get_dispatcher().submit({ encrypt, data, options, [promise](std::vector<uint8_t> output, std::exception_ptr error) {
+            if (error) {
+                promise->set_exception(error);
+            }
+            else {
+                promise->set_value(std::move(output));
+            }
+        } });
+
+        return result;
+    }
+}
+
+catalyst::request_cancelled::request_cancelled() : std::runtime_error("catalyst: request cancelled") {}
+catalyst::deadline_exceeded::deadline_exceeded() : std::runtime_error("catalyst: request deadline exceeded") {}
+
+catalyst::cancellation_token::cancellation_token() : _cancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+void catalyst::cancellation_token::cancel() {
+    _cancelled->store(true);
+}
+bool catalyst::cancellation_token::cancelled() const {
+    return _cancelled->load();
+}
+
+std::future<std::vector<uint8_t>> catalyst::encrypt_async(const catalyst::input_data& data, const catalyst::async_options& options) {
+    return submit_future(true, data, options);
+}
+void catalyst::encrypt_async(const catalyst::input_data& data, catalyst::completion_callback done, const catalyst::async_options& options) {
+    get_dispatcher().submit({ true, data, options, std::move(done) });
+}
+
+std::future<std::vector<uint8_t>> catalyst::decrypt_async(const catalyst::input_data& data, const catalyst::async_options& options) {
+    return submit_future(false, data, options);
+}
+void catalyst::decrypt_async(const catalyst::input_data& data, catalyst::completion_callback done, const catalyst::async_options& options) {
+    get_dispatcher().submit({ false, data, options, std::move(done) });
+}
\ No newline at end of file
@@ -1,30 +1,27 @@
-#include <iostream>
-#include <algorithm>
-#include <random>
-#include <vector>
-#include <cstdint>
-
-#include "catalyst_internal.hpp"
-
-// randomly generated bytes do not have any real meaning at all
-// mt1993 is used here to make the example of the implementation easier to understand
-// using a cryptographically secure PRNG is preferred though
-std::vector<uint8_t> catalyst::Extend::generate(uint64_t cipher_length, uint64_t key_length) {
-    const size_t max_extension = cipher_length ^ (key_length & cipher_length);
-
-    std::random_device rd;
-    std::mt19937 g{rd()};
-
-    const uint32_t random_n = g();
-    const uint8_t extension_size = max_extension > 1 ? random_n % max_extension : max_extension + 2;
-
-    std::vector<uint8_t> extension(extension_size + 1, 0);
-    extension[extension_size] = extension_size;
-
-    g = std::mt19937{rd()};
-    for (size_t i = 0; i < extension_size; ++i) {
-        extension[i] = (uint8_t)g();
-    }
-
-    return extension;
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+
+#include "catalyst_internal.hpp"
+
+// randomly generated bytes do not have any real meaning at all, they come from catalyst::Random
+// (a per-thread DRBG unless catalyst::set_random_source / set_random_seed replaced it)
+std::vector<uint8_t> catalyst::Extend::generate(uint64_t cipher_length, uint64_t key_length) {
+    const size_t max_extension = cipher_length ^ (key_length & cipher_length);
+
+    uint8_t random_bytes[sizeof(uint32_t)];
+    catalyst::Random::generate(random_bytes, sizeof(random_bytes));
+
+    uint32_t random_n = 0;
+    for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+        random_n |= (uint32_t)random_bytes[i] << (8 * i);
+    }
+    const uint8_t extension_size = max_extension > 1 ? random_n % max_extension : max_extension + 2;
+
+    std::vector<uint8_t> extension(extension_size + 1, 0);
+    extension[extension_size] = extension_size;
+    catalyst::Random::generate(extension.data(), extension_size);
+
+    return extension;
 }
\ No newline at end of file
@@ -0,0 +1,165 @@
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <array>
+#include <span>
+#include <vector>
+
+#include "catalyst_internal.hpp"
+#include "../catalyst.hpp"
+
+// the stages only mix bytes with their position, except for the stage 3 rotation: after r rounds
+// cipher[i] = S^r(x[(i + r) % n]) + T[i % 256] where x is the stage 2 output, so the data is read once,
+// tile by tile, running stages 1 to 3 on x then writing the tile r bytes earlier through stage 5
+namespace {
+    using catalyst::Fused::tile_size;
+
+    // stage 2 on the bytes [begin, end) of x held in <x>, the bytes after the last whole word
+    // of the <n> bytes message get the low byte of sigma of their constant
+    void stage2_tile(uint8_t* x, size_t begin, size_t end, size_t n, const catalyst::key_schedule& schedule) {
+        const std::array<uint32_t, 32>& constants_set = schedule.s2_constants;
+        uint32_t(*const sigma)(uint32_t) = schedule.s2_transform;
+
+        const size_t words_end = std::max(begin, std::min(end, n - n % sizeof(uint32_t)));
+        catalyst::sigmas::mix(schedule.s2_sigma, x, (words_end - begin) / sizeof(uint32_t), begin / sizeof(uint32_t), constants_set);
+
+        for (size_t j = words_end; j < end; ++j) {
+            x[j - begin] += (uint8_t)sigma(constants_set[j % 32]);
+        }
+    }
+    void Istage2_tile(uint8_t* x, size_t begin, size_t end, size_t n, const catalyst::key_schedule& schedule) {
+        const std::array<uint32_t, 32>& constants_set = schedule.s2_constants;
+        uint32_t(*const sigma)(uint32_t) = schedule.s2_transform;
+
+        const size_t words_end = std::max(begin, std::min(end, n - n % sizeof(uint32_t)));
+        catalyst::sigmas::unmix(schedule.s2_sigma, x, (words_end - begin) / sizeof(uint32_t), begin / sizeof(uint32_t), constants_set);
+
+        for (size_t j = words_end; j < end; ++j) {
+            x[j - begin] -= (uint8_t)sigma(constants_set[j % 32]);
+        }
+    }
+}
+
+size_t catalyst::Fused::encrypt(std::span<const uint8_t> plain, std::span<uint8_t> cipher, const catalyst::key_schedule& schedule) {
+    const size_t n = plain.size();
+    const size_t rot = n != 0 ? schedule.s3_rounds % n : 0;
+
+    catalyst::cached_stream<catalyst::constants::extension_stream, catalyst::constants::max_cached_chunks>::reader constants(*schedule.s1_extended);
+    catalyst::cached_stream<catalyst::Xor::keystream>::reader keystream(*schedule.s5_keystream);
+
+    uint8_t x[tile_size];
+    uint8_t k[tile_size];
+    // x[0, rot) ends up at the end of the cipher, after every other byte has been read
+    uint8_t wrapped[catalyst::SBox::max_rounds];
+
+    // the stage 3 transform add is done along with stage 5 and counted with it
+    catalyst::Stats::sections stats;
+
+    size_t out = 0;
+    // stages 3 (transform add) and 5 on the next <len> cipher bytes
+    const auto emit = [&](const uint8_t* src, size_t len, bool transform) {
+        keystream.read(k, len);
+        for (size_t i = 0; i < len; ++i) {
+            const uint8_t v = transform ? src[i] + schedule.s3_transform_data[(out + i) % catalyst::SBox::sbox_size] : src[i];
+            cipher[out + i] = v ^ k[i];
+        }
+        out += len;
+    };
+
+    for (size_t begin = 0; begin < n; begin += tile_size) {
+        const size_t end = std::min(n, begin + tile_size);
+        const size_t len = end - begin;
+
+        for (size_t i = 0; i < len; ) {
+            const std::span<const uint8_t> c = constants.next(len - i);
+            for (size_t j = 0; j < c.size(); ++j, ++i) {
+                x[i] = plain[begin + i] + c[j];
+            }
+        }
+        stats.mark(catalyst::stats::counter::stage1, len);
+
+        stage2_tile(x, begin, end, n, schedule);
+        stats.mark(catalyst::stats::counter::stage2, len);
+        catalyst::SBox::substitute(x, len, schedule.s3_sbox);
+
+        const size_t skip = begin < rot ? std::min(rot, end) - begin : 0;
+        std::copy_n(x, skip, wrapped + begin);
+        stats.mark(catalyst::stats::counter::stage3, len);
+
+        emit(x + skip, len - skip, true);
+        stats.mark(catalyst::stats::counter::stage5, len - skip);
+    }
+    emit(wrapped, rot, true);
+    stats.mark(catalyst::stats::counter::stage5, rot);
+
+    const std::vector<uint8_t> extension = catalyst::Extend::generate(n, schedule.key.size());
+    stats.mark(catalyst::stats::counter::stage4, extension.size());
+    emit(extension.data(), extension.size(), false);
+    stats.mark(catalyst::stats::counter::stage5, extension.size());
+
+    return out;
+}
+
+size_t catalyst::Fused::decrypt(std::span<const uint8_t> cipher, std::span<uint8_t> plain, const catalyst::key_schedule& schedule) {
+    // the Istage3 transform subtraction is counted with the substitution
+    catalyst::Stats::sections stats;
+
+    // the plain length is only known once the last byte has gone through stage 5
+    {
+        catalyst::cached_stream<catalyst::Xor::keystream>::reader keystream(*schedule.s5_keystream);
+        uint8_t k[tile_size];
+
+        for (size_t begin = 0; begin < cipher.size(); begin += tile_size) {
+            const size_t len = std::min(cipher.size() - begin, tile_size);
+            keystream.read(k, len);
+            for (size_t i = 0; i < len; ++i) {
+                plain[begin + i] = cipher[begin + i] ^ k[i];
+            }
+        }
+    }
+    stats.mark(catalyst::stats::counter::stage5, cipher.size());
+
+    if (cipher.empty() || (size_t)plain[cipher.size() - 1] + 1 > cipher.size()) {
+        throw std::runtime_error("catalyst: invalid cipher");
+    }
+    const size_t n = cipher.size() - plain[cipher.size() - 1] - 1;
+    stats.mark(catalyst::stats::counter::Istage4, cipher.size());
+    const size_t rot = n != 0 ? schedule.s3_rounds % n : 0;
+
+    catalyst::cached_stream<catalyst::constants::extension_stream, catalyst::constants::max_cached_chunks>::reader constants(*schedule.s1_extended);
+
+    // x[j] comes from y[(j - rot) % n], the rot bytes before each tile are kept aside before the previous
+    // tile overwrites them, starting with the end of the data for the first one
+    uint8_t y[catalyst::SBox::max_rounds + tile_size];
+    uint8_t carry[catalyst::SBox::max_rounds];
+    std::copy_n(plain.begin() + (n - rot), rot, carry);
+
+    for (size_t begin = 0; begin < n; begin += tile_size) {
+        const size_t end = std::min(n, begin + tile_size);
+        const size_t len = end - begin;
+
+        std::copy_n(carry, rot, y);
+        std::copy_n(plain.begin() + begin, len, y + rot);
+        std::copy_n(y + len, rot, carry);
+
+        uint8_t* const x = y;
+        for (size_t i = 0, p = (begin + n - rot) % n; i < len; ++i, p = p + 1 == n ? 0 : p + 1) {
+            x[i] -= schedule.s3_transform_data[p % catalyst::SBox::sbox_size];
+        }
+        catalyst::SBox::substitute(x, len, schedule.s3_Isbox);
+        stats.mark(catalyst::stats::counter::Istage3, len);
+
+        Istage2_tile(x, begin, end, n, schedule);
+        stats.mark(catalyst::stats::counter::Istage2, len);
+
+        for (size_t i = 0; i < len; ) {
+            const std::span<const uint8_t> c = constants.next(len - i);
+            for (size_t j = 0; j < c.size(); ++j, ++i) {
+                plain[begin + i] = x[i] - c[j];
+            }
+        }
+        stats.mark(catalyst::stats::counter::Istage1, len);
+    }
+
+    return n;
+}
@@ -1,67 +1,90 @@
-#include <iostream>
-#include <vector>
-
-#include <boost/multiprecision/cpp_int.hpp>
-
-#include "catalyst_internal.hpp"
-
-namespace {
-    size_t get_bits(const bmp::cpp_int& n) {
-        std::vector<uint8_t> _temp;
-        export_bits(n, std::back_inserter(_temp), 1);
-        return _temp.size();
-    }
-}
-
-bmp::cpp_int catalyst::helper::bytes_to_int(const std::vector<uint8_t>& data) {
-    bmp::cpp_int s = 0;
-    for (uint64_t i = 0; i < data.size(); ++i) {
-        s += (bmp::cpp_int)data[i] << (i * 8);
-    }
-    return s;
-}
-
-std::vector<uint64_t> catalyst::helper::generate_prime_numbers(const uint64_t& n) {
-    std::vector<uint64_t> primes = { 2,3,5,7,11,13,17,19,23,29,31,37,41,43,47,53,59,61,67,71,73,79,83,89,97,101,103,107,109,113,127,131,137 };
-    if (n <= primes.back()) {
-        while (primes.back() > n) {
-            primes.pop_back();
-        }
-        return primes;
-    }
-
-    uint64_t current = primes.back();
-    while (current < n) {
-        bool isPrime = true;
-        
-        for (uint64_t p = 2; p <= std::sqrt(current); ++p) {
-            if (current % p == 0) {
-                isPrime = true;
-                break;
-            }
-        }
-
-        if (isPrime) {
-            primes.push_back(current);
-        }
-        ++current;
-    }
-
-    return primes;
-}
-
-uint64_t catalyst::helper::get_rounds(const bmp::cpp_int& key) {
-    const size_t n_bits = get_bits(key);
-    
-    uint64_t s = 0;
-    for (uint64_t i = 0; i < n_bits; ++i) {
-        s += (uint64_t)((key >> i) & 1); 
-    }
-
-    uint64_t n_rounds = 0;
-    for (const auto& p : generate_prime_numbers(s / 2)) {
-        n_rounds += s % p;
-    }
-
-    return n_rounds;
+#include <iostream>
+#include <array>
+#include <bit>
+#include <cstring>
+
+#include "catalyst_internal.hpp"
+
+namespace {
+    // the base prime list, sieved at compile time
+    constexpr uint64_t sieve_limit = 137;
+
+    constexpr size_t count_primes() {
+        std::array<bool, sieve_limit + 1> composite = {};
+        size_t count = 0;
+
+        for (uint64_t i = 2; i <= sieve_limit; ++i) {
+            if (!composite[i]) {
+                ++count;
+                for (uint64_t j = i * i; j <= sieve_limit; j += i) {
+                    composite[j] = true;
+                }
+            }
+        }
+
+        return count;
+    }
+
+    constexpr std::array<uint64_t, count_primes()> sieve_primes() {
+        std::array<bool, sieve_limit + 1> composite = {};
+        std::array<uint64_t, count_primes()> primes = {};
+        size_t count = 0;
+
+        for (uint64_t i = 2; i <= sieve_limit; ++i) {
+            if (!composite[i]) {
+                primes[count++] = i;
+                for (uint64_t j = i * i; j <= sieve_limit; j += i) {
+                    composite[j] = true;
+                }
+            }
+        }
+
+        return primes;
+    }
+    constexpr std::array<uint64_t, count_primes()> small_primes = sieve_primes();
+    static_assert(small_primes.size() == 33 && small_primes.back() == sieve_limit);
+}
+
+// the list used to be generated by trial division that accepted every candidate past the base list,
+// which the existing ciphers depend on: for n > 137 it is the primes up to 137, then 137, 138, ..., n - 1
+std::vector<uint64_t> catalyst::helper::generate_prime_numbers(const uint64_t& n) {
+    std::vector<uint64_t> primes;
+    for (const auto& p : small_primes) {
+        if (p <= n) {
+            primes.push_back(p);
+        }
+    }
+    for (uint64_t current = sieve_limit; current < n; ++current) {
+        primes.push_back(current);
+    }
+    return primes;
+}
+
+// s = number of set bits of the key, n_rounds = sum of s % p over generate_prime_numbers(s / 2)
+uint64_t catalyst::helper::get_rounds(const uint8_t key_data[], uint64_t length) {
+    uint64_t s = 0;
+
+    uint64_t i = 0;
+    for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, key_data + i, sizeof(word));
+        s += std::popcount(word);
+    }
+    for (; i < length; ++i) {
+        s += std::popcount(key_data[i]);
+    }
+
+    const uint64_t n = s / 2;
+
+    uint64_t n_rounds = 0;
+    for (const auto& p : small_primes) {
+        if (p <= n) {
+            n_rounds += s % p;
+        }
+    }
+    for (uint64_t p = sieve_limit; p < n; ++p) {
+        n_rounds += s % p;
+    }
+
+    return n_rounds;
 }
\ No newline at end of file
@@ -1,92 +1,533 @@
-#pragma once
-
-#include <iostream>
-#include <cmath>
-#include <cstdint>
-#include <array>
-#include <vector>
-
-#include <boost/multiprecision/cpp_int.hpp>
-
-namespace bmp = boost::multiprecision;
-
-namespace catalyst {
-    namespace helper {
-        bmp::cpp_int bytes_to_int(const std::vector<uint8_t>& data);
-        std::vector<uint64_t> generate_prime_numbers(const uint64_t& n);
-        uint64_t get_rounds(const bmp::cpp_int& key);
-    };
-    namespace constants {
-        namespace sigma {
-            std::array<uint32_t, 32> get_constants_1();
-            std::array<uint32_t, 32> get_constants_2();
-            std::array<uint32_t, 32> get_constants_3();
-            std::array<uint32_t, 32> get_constants_4();
-            const std::array<uint32_t, 32>& get_constants_set(uint8_t key_data[], uint64_t length);
-
-            inline const std::array<std::array<uint32_t, 32>, 4>& constants = { get_constants_1(), get_constants_2(), get_constants_3(), get_constants_4() };
-        }
-
-        std::vector<uint32_t> get_constants_1();
-        std::vector<uint32_t> get_constants_2();
-        std::vector<uint32_t> get_constants_3();
-        std::vector<uint32_t> get_constants_4();
-        std::vector<uint32_t> extend_constants(const std::vector<uint32_t>& constants, uint64_t length);
-        const std::vector<uint32_t>& get_constants_set(uint8_t key_data[], uint64_t length);
-
-        inline const std::array<std::vector<uint32_t>, 4> constants = { get_constants_1(), get_constants_2(), get_constants_3(), get_constants_4() };
-    }
-    namespace sigmas {
-        uint32_t sigma0(uint32_t x);
-        uint32_t sigma1(uint32_t x);
-        uint32_t Sigma0(uint32_t x);
-        uint32_t Sigma1(uint32_t x);
-
-        uint32_t Isigma0(uint32_t x);
-        uint32_t Isigma1(uint32_t x);
-        uint32_t ISigma0(uint32_t x);
-        uint32_t ISigma1(uint32_t x);
-
-        uint32_t(*get_sigma(uint8_t key_data[], uint64_t length))(uint32_t);
-        uint32_t(*get_Isigma(uint8_t key_data[], uint64_t length))(uint32_t);
-
-        inline const std::array<uint32_t(*)(uint32_t), 4> sigmas = { &sigma0, &sigma1, &Sigma0, &Sigma1 };
-        inline const std::array<uint32_t(*)(uint32_t), 4> Isigmas = { &Isigma0, &Isigma1, &ISigma0, &ISigma1 };
-    }
-    namespace SBox {
-        constexpr size_t sbox_size = 256;
-
-        const std::array<uint8_t, sbox_size>& get_sbox();
-        const std::array<uint8_t, sbox_size>& get_inverse_sbox();
-
-        std::array<uint8_t, sbox_size> get_transform(uint8_t key_data[], uint64_t length);
-    }
-    namespace Extend {
-        std::vector<uint8_t> generate(uint64_t cipher_length, uint64_t key_length);
-    }
-    namespace Xor {
-        std::vector<uint8_t> generate_transform(uint8_t key_data[], uint64_t length, uint64_t n);
-    }
-
-    struct state {
-        std::vector<uint32_t> s1_constants;
-
-        std::array<uint32_t, 32> s2_constants;
-        uint32_t(*s2_transform)(uint32_t);
-        uint32_t(*s2_Itransform)(uint32_t);
-
-        std::array<uint8_t, SBox::sbox_size> s3_sbox;
-        std::array<uint8_t, SBox::sbox_size> s3_Isbox;
-        std::array<uint8_t, SBox::sbox_size> s3_transform_data;
-
-        std::vector<uint8_t> s4_random_bytes;
-
-        std::vector<uint8_t> s5_transform_data;
-
-        bmp::cpp_int key_n;
-        size_t n_rounds;
-
-        std::vector<uint8_t> plain;
-        std::vector<uint8_t> cipher;
-    };
+#pragma once
+
+#include <iostream>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "../catalyst.hpp"
+#include "../sha3/sha3.hpp"
+
+namespace catalyst {
+    // bytes of a stream (with a next() returning its following bytes) kept as they are generated, so that every
+    // reader only waits for the bytes past the longest prefix read so far; the first max_chunks * chunk_size bytes
+    // are kept, readers generate the rest themselves
+    template<typename Stream, size_t max_chunks = 64> class cached_stream {
+    private:
+        // stream bytes read in arbitrary amounts, copies carry on from the same position
+        class generator {
+        public:
+            template<typename... Args> explicit generator(Args&&... args) : _stream(std::forward<Args>(args)...) {}
+
+            // the next bytes of the stream, at most <max> of them
+            std::span<const uint8_t> next(size_t max) {
+                if (_offset == _block.size()) {
+                    const std::span<const uint8_t> block = _stream.next();
+                    _block.assign(block.begin(), block.end());
+                    _offset = 0;
+                }
+
+                const std::span<const uint8_t> bytes = std::span<const uint8_t>(_block).subspan(_offset, std::min(max, _block.size() - _offset));
+                _offset += bytes.size();
+                return bytes;
+            }
+        private:
+            Stream _stream;
+            std::vector<uint8_t> _block;
+            size_t _offset = 0;
+        };
+    public:
+        static constexpr size_t chunk_size = 64 * 1024;
+        static constexpr size_t max_cached = chunk_size * max_chunks;
+
+        template<typename... Args> explicit cached_stream(Args&&... args) : _generator(std::forward<Args>(args)...) {}
+
+        // the stream from its start, several readers may run at once on different threads
+        class reader {
+        public:
+            explicit reader(const cached_stream& cache) : _cache(cache) {}
+
+            // the next bytes of the stream, at most <max> of them
+            std::span<const uint8_t> next(size_t max) {
+                if (_position < max_cached) {
+                    const size_t end = std::min(_position + max, max_cached);
+                    if (_cache._size.load(std::memory_order_acquire) < end) {
+                        _cache.grow(end);
+                    }
+
+                    const size_t offset = _position % chunk_size;
+                    const size_t count = std::min(end - _position, chunk_size - offset);
+                    const std::span<const uint8_t> bytes(_cache._chunks[_position / chunk_size].get() + offset, count);
+
+                    _position += count;
+                    return bytes;
+                }
+
+                if (!_tail) {
+                    _cache.grow(max_cached);
+
+                    std::lock_guard<std::mutex> lock(_cache._mutex);
+                    _tail.emplace(static_cast<const generator&>(_cache._generator));
+                }
+                return _tail->next(max);
+            }
+
+            void read(uint8_t* out, size_t n) {
+                while (n != 0) {
+                    const std::span<const uint8_t> bytes = next(n);
+                    std::copy(bytes.begin(), bytes.end(), out);
+
+                    out += bytes.size();
+                    n -= bytes.size();
+                }
+            }
+        private:
+            const cached_stream& _cache;
+            size_t _position = 0;
+            // past the first max_cached bytes
+            std::optional<generator> _tail;
+        };
+    private:
+        // makes at least <size> bytes available (size <= max_cached), readers only touch the bytes below _size,
+        // which are never written again, so they need no lock
+        void grow(size_t size) const {
+            // nothing past what was asked, a one-shot message under a fresh key only pays for its own bytes
+            const size_t target = std::min(max_cached, size);
+
+            // one chunk per lock, readers of the bytes already published carry on and the shared extended sets
+            // are not held up for the whole of a large growth
+            for (;;) {
+                std::lock_guard<std::mutex> lock(_mutex);
+
+                size_t current = _size.load(std::memory_order_relaxed);
+                if (current >= target) {
+                    return;
+                }
+
+                std::unique_ptr<uint8_t[]>& chunk = _chunks[current / chunk_size];
+                if (!chunk) {
+                    // left uninitialized, only the bytes below _size are ever read
+                    chunk = std::make_unique_for_overwrite<uint8_t[]>(chunk_size);
+                }
+
+                const size_t end = std::min(target, (current / chunk_size + 1) * chunk_size);
+                while (current < end) {
+                    const std::span<const uint8_t> bytes = _generator.next(end - current);
+                    std::copy(bytes.begin(), bytes.end(), chunk.get() + current % chunk_size);
+                    current += bytes.size();
+                }
+
+                _size.store(current, std::memory_order_release);
+            }
+        }
+
+        mutable std::mutex _mutex;
+        mutable generator _generator;
+        mutable std::array<std::unique_ptr<uint8_t[]>, max_chunks> _chunks;
+        mutable std::atomic<size_t> _size = 0;
+    };
+
+    namespace helper {
+        std::vector<uint64_t> generate_prime_numbers(const uint64_t& n);
+        uint64_t get_rounds(const uint8_t key_data[], uint64_t length);
+    };
+    namespace constants {
+        namespace sigma {
+            std::array<uint32_t, 32> get_constants_1();
+            std::array<uint32_t, 32> get_constants_2();
+            std::array<uint32_t, 32> get_constants_3();
+            std::array<uint32_t, 32> get_constants_4();
+            const std::array<uint32_t, 32>& get_constants_set(uint8_t key_data[], uint64_t length);
+
+            inline const std::array<std::array<uint32_t, 32>, 4>& constants = { get_constants_1(), get_constants_2(), get_constants_3(), get_constants_4() };
+        }
+
+        std::vector<uint32_t> get_constants_1();
+        std::vector<uint32_t> get_constants_2();
+        std::vector<uint32_t> get_constants_3();
+        std::vector<uint32_t> get_constants_4();
+        std::vector<uint32_t> extend_constants(const std::vector<uint32_t>& constants, uint64_t length);
+        const std::vector<uint32_t>& get_constants_set(uint8_t key_data[], uint64_t length);
+
+        // bytes of extend_constants(<constants>, length) for any length, in order, without storing them:
+        // the first call returns the whole base set, every following call the next extension block
+        class extension_stream {
+        public:
+            explicit extension_stream(const std::vector<uint32_t>& constants);
+
+            std::span<const uint8_t> next();
+        private:
+            static constexpr size_t block_words = 8;
+
+            const std::vector<uint32_t>& _constants;
+            SHA3::SHAKE::context<256> _sponge;
+            std::array<uint32_t, block_words> _block;
+            bool _base_read = false;
+        };
+
+        inline const std::array<std::vector<uint32_t>, 4> constants = { get_constants_1(), get_constants_2(), get_constants_3(), get_constants_4() };
+
+        // the extension only depends on the base set, so the four of them are shared by every key
+        constexpr size_t max_cached_chunks = 256;
+        const cached_stream<extension_stream, max_cached_chunks>& get_extended_set(uint8_t key_data[], uint64_t length);
+    }
+    namespace sigmas {
+        uint32_t sigma0(uint32_t x);
+        uint32_t sigma1(uint32_t x);
+        uint32_t Sigma0(uint32_t x);
+        uint32_t Sigma1(uint32_t x);
+
+        uint32_t Isigma0(uint32_t x);
+        uint32_t Isigma1(uint32_t x);
+        uint32_t ISigma0(uint32_t x);
+        uint32_t ISigma1(uint32_t x);
+
+        // the sigmas are linear over GF(2): the inverse of sigmas[i] maps bit j to singleton_inverses[i][j]
+        inline constexpr std::array<std::array<uint32_t, 32>, 4> singleton_inverses = {{
+            // Isigma0
+            {
+                0x185744e9, 0x30ae89d2, 0x615d13a4, 0xdaed63a1, 0x9cd03a8e, 0x08fdcc39,
+                0x11fb9872, 0x23f730e4, 0x5fb92521, 0xbf724a42, 0x57ee6948, 0xafdcd290,
+                0x76b358ec, 0xf531f531, 0xc36917ae, 0xb78f9679, 0x4615d13e, 0x947ce695,
+                0x19a4740f, 0x2b1facf7, 0x4e681d07, 0x84877ee7, 0x385344eb, 0x70a689d6,
+                0xf91a5745, 0xc36917af, 0xb78f967b, 0x4615d13a, 0x8c2ba274, 0x290afdcd,
+                0x4a42bf73, 0x94857ee6
+            },
+            // Isigma1
+            {
+                0x2ccfffed, 0x75500037, 0xeaa0006e, 0x589d5570, 0xb13aaae0, 0xc367ff81,
+                0x27dd5543, 0x4fbaaa86, 0xb3baaae1, 0xc667ff83, 0x2ddd5547, 0x5bbaaa8e,
+                0x9bbaaaf1, 0x9667ffa3, 0x8ddd5507, 0x9667ffa2, 0x8ddd5505, 0x9667ffa6,
+                0x8ddd550d, 0x9667ffb6, 0x8ddd552d, 0x9667fff6, 0x8ddd55ad, 0x9667fef6,
+                0x8ddd57ad, 0xbaa8051b, 0xf88d5f9a, 0x50081575, 0xa0102aea, 0xe132ff95,
+                0x6377556b, 0xc6eeaad6
+            },
+            // ISigma0
+            {
+                0xcbd1a68d, 0x97a34d1b, 0x2f469a37, 0x5e8d346e, 0xbd1a68dc, 0x7a34d1b9,
+                0xf469a372, 0xe8d346e5, 0xd1a68dcb, 0xa34d1b97, 0x469a372f, 0x8d346e5e,
+                0x1a68dcbd, 0x34d1b97a, 0x69a372f4, 0xd346e5e8, 0xa68dcbd1, 0x4d1b97a3,
+                0x9a372f46, 0x346e5e8d, 0x68dcbd1a, 0xd1b97a34, 0xa372f469, 0x46e5e8d3,
+                0x8dcbd1a6, 0x1b97a34d, 0x372f469a, 0x6e5e8d34, 0xdcbd1a68, 0xb97a34d1,
+                0x72f469a3, 0xe5e8d346
+            },
+            // ISigma1
+            {
+                0x6ab84f6c, 0xd5709ed8, 0xaae13db1, 0x55c27b63, 0xab84f6c6, 0x5709ed8d,
+                0xae13db1a, 0x5c27b635, 0xb84f6c6a, 0x709ed8d5, 0xe13db1aa, 0xc27b6355,
+                0x84f6c6ab, 0x09ed8d57, 0x13db1aae, 0x27b6355c, 0x4f6c6ab8, 0x9ed8d570,
+                0x3db1aae1, 0x7b6355c2, 0xf6c6ab84, 0xed8d5709, 0xdb1aae13, 0xb6355c27,
+                0x6c6ab84f, 0xd8d5709e, 0xb1aae13d, 0x6355c27b, 0xc6ab84f6, 0x8d5709ed,
+                0x1aae13db, 0x355c27b6
+            }
+        }};
+
+        typedef std::array<std::array<uint32_t, 256>, 4> byte_sliced_table;
+
+        // inverse of sigmas[i] one byte at a time: Isigmas[i](x) = XOR over byte j of x of inverse_tables[i][j][byte j]
+        constexpr std::array<byte_sliced_table, 4> make_inverse_tables() {
+            std::array<byte_sliced_table, 4> tables = {};
+
+            for (size_t i = 0; i < tables.size(); ++i) {
+                for (size_t j = 0; j < 4; ++j) {
+                    for (uint32_t byte = 0; byte < 256; ++byte) {
+                        uint32_t r = 0;
+                        for (uint32_t bit = 0; bit < 8; ++bit) {
+                            if ((byte >> bit) & 1) {
+                                r ^= singleton_inverses[i][8 * j + bit];
+                            }
+                        }
+                        tables[i][j][byte] = r;
+                    }
+                }
+            }
+
+            return tables;
+        }
+        inline constexpr std::array<byte_sliced_table, 4> inverse_tables = make_inverse_tables();
+
+        // bytes of the key's SHAKE128 that the sigma index is drawn from
+        constexpr size_t sigma_hash_size = 16;
+
+        size_t get_sigma_index(uint8_t key_data[], uint64_t length);
+        // get_sigma_index for a key whose SHAKE128 is already known, e.g. hashed along with other keys by SHA3::batch
+        size_t get_sigma_index(const uint8_t key_data[], uint64_t length, const uint8_t key_shake128[sigma_hash_size]);
+        uint32_t(*get_sigma(uint8_t key_data[], uint64_t length))(uint32_t);
+        uint32_t(*get_Isigma(uint8_t key_data[], uint64_t length))(uint32_t);
+
+        inline const std::array<uint32_t(*)(uint32_t), 4> sigmas = { &sigma0, &sigma1, &Sigma0, &Sigma1 };
+        inline const std::array<uint32_t(*)(uint32_t), 4> Isigmas = { &Isigma0, &Isigma1, &ISigma0, &ISigma1 };
+
+        // stage 2 on the <n_words> whole words at <data>, the first one being word <first_word> of the message:
+        // mix: word = sigmas[index](big endian word + constant), unmix: big endian word = Isigmas[index](word) - constant,
+        // using the widest instruction set the CPU supports
+        void mix(size_t index, uint8_t* data, size_t n_words, size_t first_word, const std::array<uint32_t, 32>& constants);
+        void unmix(size_t index, uint8_t* data, size_t n_words, size_t first_word, const std::array<uint32_t, 32>& constants);
+        // name of the instruction sets used by mix / unmix ("avx512+gfni", "avx512", "avx2" or "generic")
+        const char* mix_implementation();
+
+        void mix_generic(size_t index, uint8_t* data, size_t n_words, size_t first_word, const std::array<uint32_t, 32>& constants);
+        void unmix_generic(size_t index, uint8_t* data, size_t n_words, size_t first_word, const std::array<uint32_t, 32>& constants);
+        void mix_avx2(size_t index, uint8_t* data, size_t n_words, size_t first_word, const std::array<uint32_t, 32>& constants);
+        void unmix_avx2(size_t index, uint8_t* data, size_t n_words, size_t first_word, const std::array<uint32_t, 32>& constants);
+        void mix_avx512(size_t index, uint8_t* data, size_t n_words, size_t first_word, const std::array<uint32_t, 32>& constants);
+        void unmix_avx512(size_t index, uint8_t* data, size_t n_words, size_t first_word, const std::array<uint32_t, 32>& constants);
+        // unmix as GF(2) matrix products (AVX-512 VBMI + GFNI)
+        void unmix_gfni(size_t index, uint8_t* data, size_t n_words, size_t first_word, const std::array<uint32_t, 32>& constants);
+    }
+    namespace SBox {
+        constexpr size_t sbox_size = 256;
+
+        const std::array<uint8_t, sbox_size>& get_sbox();
+        const std::array<uint8_t, sbox_size>& get_inverse_sbox();
+        // stage 3 does 1 + ceil(log2(n_rounds)) rounds with a 64 bits n_rounds
+        constexpr size_t max_rounds = 65;
+        // sbox (inverse sbox) applied <rounds> times, tables for every round count are built at compile time
+        const std::array<uint8_t, sbox_size>& get_sbox(size_t rounds);
+        const std::array<uint8_t, sbox_size>& get_inverse_sbox(size_t rounds);
+
+        std::array<uint8_t, sbox_size> get_transform(uint8_t key_data[], uint64_t length);
+
+        // data[i] = table[data[i]] for the <n> bytes at <data>, using the widest kernel the CPU supports
+        void substitute(uint8_t* data, size_t n, const std::array<uint8_t, sbox_size>& table);
+        // name of the kernel picked by substitute ("avx512vbmi", "avx2" or "scalar")
+        const char* substitute_implementation();
+
+        // vector kernels only go over whole vectors and return the number of bytes substituted
+        size_t substitute_scalar(uint8_t* data, size_t n, const uint8_t table[sbox_size]);
+        size_t substitute_ssse3(uint8_t* data, size_t n, const uint8_t table[sbox_size]);
+        size_t substitute_avx2(uint8_t* data, size_t n, const uint8_t table[sbox_size]);
+        size_t substitute_avx512vbmi(uint8_t* data, size_t n, const uint8_t table[sbox_size]);
+    }
+    namespace Extend {
+        std::vector<uint8_t> generate(uint64_t cipher_length, uint64_t key_length);
+    }
+    // catalyst::stats counters, the calls below compile to nothing without CATALYST_STATS
+    namespace Stats {
+#if defined(CATALYST_STATS)
+        extern std::atomic<bool> enabled;
+
+        inline bool active() {
+            return enabled.load(std::memory_order_relaxed);
+        }
+        uint64_t now();
+        void add(stats::counter c, uint64_t calls, uint64_t bytes, uint64_t nanoseconds, uint64_t hashes);
+
+        // counts one call of <c> over <bytes> bytes, timed until the end of the scope
+        class scope {
+        public:
+            explicit scope(stats::counter c, uint64_t bytes = 0, uint64_t hashes = 0)
+                : _counter(c), _bytes(bytes), _hashes(hashes), _start(active() ? now() : 0) {}
+            ~scope() {
+                if (_start != 0) {
+                    Stats::add(_counter, 1, _bytes, now() - _start, _hashes);
+                }
+            }
+            scope(const scope&) = delete;
+            scope& operator=(const scope&) = delete;
+
+            void add(uint64_t bytes, uint64_t hashes = 0) {
+                _bytes += bytes;
+                _hashes += hashes;
+            }
+        private:
+            stats::counter _counter;
+            uint64_t _bytes;
+            uint64_t _hashes;
+            uint64_t _start;
+        };
+
+        // times the consecutive sections of one call, mark(c, bytes) gives the time since the previous mark to <c>,
+        // every counter marked counts a single call once the object is destroyed
+        class sections {
+        public:
+            sections() : _last(active() ? now() : 0) {}
+            ~sections() {
+                for (size_t i = 0; i < _n; ++i) {
+                    Stats::add(_entries[i].c, 1, _entries[i].bytes, _entries[i].nanoseconds, 0);
+                }
+            }
+            sections(const sections&) = delete;
+            sections& operator=(const sections&) = delete;
+
+            void mark(stats::counter c, uint64_t bytes) {
+                if (_last == 0) {
+                    return;
+                }
+
+                const uint64_t t = now();
+                size_t i = 0;
+                while (i < _n && _entries[i].c != c) {
+                    ++i;
+                }
+                if (i == _n) {
+                    if (_n == _entries.size()) {
+                        return;
+                    }
+                    _entries[_n++] = { c, 0, 0 };
+                }
+
+                _entries[i].bytes += bytes;
+                _entries[i].nanoseconds += t - _last;
+                _last = t;
+            }
+        private:
+            struct entry {
+                stats::counter c;
+                uint64_t bytes;
+                uint64_t nanoseconds;
+            };
+
+            // a call marks a handful of counters, never all of them
+            std::array<entry, 8> _entries;
+            size_t _n = 0;
+            uint64_t _last;
+        };
+
+        // hash invocations done outside of a scope
+        inline void count_hashes(stats::counter c, uint64_t hashes) {
+            if (active()) {
+                Stats::add(c, 0, 0, 0, hashes);
+            }
+        }
+#else
+        class scope {
+        public:
+            explicit scope(stats::counter, uint64_t = 0, uint64_t = 0) {}
+            void add(uint64_t, uint64_t = 0) {}
+        };
+        class sections {
+        public:
+            void mark(stats::counter, uint64_t) {}
+        };
+        inline void count_hashes(stats::counter, uint64_t) {}
+#endif
+    }
+    namespace Random {
+        // <n> bytes from the catalyst::set_random_source source, by default the calling thread's DRBG
+        void generate(uint8_t* out, size_t n);
+    }
+    namespace Xor {
+        std::vector<uint8_t> generate_transform(const uint8_t key_data[], uint64_t length, uint64_t n);
+
+        // bytes of generate_transform(<key_data>, <length>, n) for any n, in order, without storing them:
+        // the first call returns the key itself, every following call the next 32 bytes hash
+        class keystream {
+        public:
+            keystream(const uint8_t key_data[], uint64_t length);
+
+            std::span<const uint8_t> next();
+        private:
+            static constexpr size_t digest_size = 32;
+
+            const uint8_t* _key;
+            uint64_t _length;
+            size_t _round_size;
+            std::array<uint8_t, digest_size> _prev;
+            std::array<uint8_t, digest_size> _hash;
+            bool _key_read = false;
+            bool _hash_read = false;
+        };
+    }
+
+    // everything that only depends on the key, computed once by catalyst::key_context
+    struct key_schedule {
+        std::vector<uint8_t> key;
+
+        const cached_stream<constants::extension_stream, constants::max_cached_chunks>* s1_extended;
+
+        std::array<uint32_t, 32> s2_constants;
+        size_t s2_sigma;
+        uint32_t(*s2_transform)(uint32_t);
+        uint32_t(*s2_Itransform)(uint32_t);
+
+        // base sbox and its inverse composed s3_rounds times
+        std::array<uint8_t, SBox::sbox_size> s3_sbox;
+        std::array<uint8_t, SBox::sbox_size> s3_Isbox;
+        std::array<uint8_t, SBox::sbox_size> s3_transform_data;
+
+        // stage 5 keystream, generated from <key> (whose buffer moves along with the schedule)
+        std::unique_ptr<cached_stream<Xor::keystream>> s5_keystream;
+
+        size_t n_rounds;
+        size_t s3_rounds;
+    };
+
+    // <sigma_hash>: the key's SHAKE128 (sigmas::sigma_hash_size bytes) when it is already known, hashed here otherwise
+    key_schedule get_key_schedule(uint8_t key_data[], uint64_t length, const uint8_t* sigma_hash = nullptr);
+
+    // both take buffers sized as checked by catalyst::encrypt / catalyst::decrypt, input and output may start
+    // at the same address, and return the output length
+    namespace Staged {
+        // every stage in turn over the whole data, reference implementation for the fused path
+        size_t encrypt(std::span<const uint8_t> plain, std::span<uint8_t> cipher, const key_schedule& schedule);
+        size_t decrypt(std::span<const uint8_t> cipher, std::span<uint8_t> plain, const key_schedule& schedule);
+
+        // the stages on their own, <out> may start at the same address as <in>
+        void stage1(std::span<const uint8_t> in, std::span<uint8_t> out, const key_schedule& schedule);
+        void Istage1(std::span<uint8_t> data, const key_schedule& schedule);
+        void stage2(std::span<uint8_t> cipher, const key_schedule& schedule);
+        void Istage2(std::span<uint8_t> cipher, const key_schedule& schedule);
+        void stage3(std::span<uint8_t> cipher, const key_schedule& schedule);
+        void Istage3(std::span<uint8_t> cipher, const key_schedule& schedule);
+        // stage4 writes the extension after the first <plain_length> bytes of <cipher> and returns the cipher length,
+        // Istage4 returns the length without the extension
+        size_t stage4(std::span<uint8_t> cipher, size_t plain_length, const key_schedule& schedule);
+        size_t Istage4(std::span<const uint8_t> cipher);
+        // involution, also its own inverse
+        void stage5(std::span<const uint8_t> in, std::span<uint8_t> out, const key_schedule& schedule);
+    }
+    namespace Fused {
+        // fits in L1 along with the other tile buffers, multiple of the stage 2 word size
+        constexpr size_t tile_size = 16 * 1024;
+
+        // every stage on one cache-sized tile after the other, same output as the staged path
+        size_t encrypt(std::span<const uint8_t> plain, std::span<uint8_t> cipher, const key_schedule& schedule);
+        size_t decrypt(std::span<const uint8_t> cipher, std::span<uint8_t> plain, const key_schedule& schedule);
+    }
+
+    // process-wide work-stealing thread pool sized by catalyst::set_concurrency
+    namespace Pool {
+        // calls f(i) for every i < n on at most <max_threads> threads (0: all of the pool's), the calling thread
+        // included, and returns once they are all done, rethrows the first exception thrown by <f>
+        void run(size_t n, const std::function<void(size_t)>& f, size_t max_threads = 0);
+        // calls f(i) for every one of <n> messages, <length>(i) bytes long: the messages are cut into runs of consecutive
+        // messages of about the same byte volume, so a huge message makes a task of its own while tiny ones are batched together
+        void run_messages(size_t n, const std::function<size_t(size_t)>& length, const std::function<void(size_t)>& f);
+        // Pool::run_messages without waiting: the runs are handed to the pool's workers (done on the calling thread
+        // when it has none) and the call returns, <f> must not throw
+        void post_messages(size_t n, const std::function<size_t(size_t)>& length, std::function<void(size_t)> f);
+    }
+
+    // framed streaming format:
+    //   stream header: magic "CATF", version, chunk size (uint32 LE)
+    //   frames: uint32 LE cipher length (bit 31 set on the last frame), then the cipher of up to chunk size
+    //   plaintext bytes encrypted with the key derived from the master key and the frame index
+    namespace Frame {
+        constexpr uint8_t magic[4] = { 'C', 'A', 'T', 'F' };
+        constexpr uint8_t version = 1;
+        constexpr size_t header_size = sizeof(magic) + 1 + sizeof(uint32_t);
+        constexpr size_t frame_header_size = sizeof(uint32_t);
+        constexpr uint32_t final_flag = 0x80000000;
+        constexpr size_t max_extension = max_extension_size;
+        constexpr size_t max_chunk_size = final_flag - max_extension;
+        constexpr size_t derived_key_size = 64;
+
+        key_context derive_key(const key_schedule& master, uint64_t index);
+
+        std::array<uint8_t, header_size> make_header(uint32_t chunk_size);
+        // returns the chunk size, throws std::runtime_error if <header> is not a stream header
+        uint32_t read_header(const uint8_t header[header_size]);
+
+        std::array<uint8_t, frame_header_size> make_frame_header(uint32_t cipher_length, bool final);
+        uint32_t read_frame_header(const uint8_t header[frame_header_size], bool& final);
+    }
 }
\ No newline at end of file
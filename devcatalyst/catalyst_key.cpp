@@ -0,0 +1,60 @@
+#include <iostream>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "catalyst_internal.hpp"
+#include "../catalyst.hpp"
+
+namespace {
+    // number of sbox rounds done by stage 3, log2(0) would diverge so n_rounds = 0 is treated as a single round
+    size_t get_sbox_rounds(uint64_t n_rounds) {
+        if (n_rounds <= 1) {
+            return 1;
+        }
+        return 1 + (size_t)std::ceil(std::log2(n_rounds));
+    }
+}
+
+catalyst::key_schedule catalyst::get_key_schedule(uint8_t key_data[], uint64_t length, const uint8_t* sigma_hash) {
+    const catalyst::Stats::scope total(catalyst::stats::counter::key_schedule, length);
+    catalyst::Stats::sections stats;
+    catalyst::key_schedule schedule;
+
+    schedule.key = std::vector<uint8_t>(key_data, key_data + length);
+
+    schedule.s1_extended = &catalyst::constants::get_extended_set(key_data, length);
+    schedule.s2_constants = catalyst::constants::sigma::get_constants_set(key_data, length);
+    stats.mark(catalyst::stats::counter::key_constants, length);
+
+    const size_t sigma_index = sigma_hash ? catalyst::sigmas::get_sigma_index(key_data, length, sigma_hash) : catalyst::sigmas::get_sigma_index(key_data, length);
+    schedule.s2_sigma = sigma_index;
+    schedule.s2_transform = catalyst::sigmas::sigmas[sigma_index];
+    schedule.s2_Itransform = catalyst::sigmas::Isigmas[sigma_index];
+    stats.mark(catalyst::stats::counter::key_sigma, length);
+
+    schedule.n_rounds = catalyst::helper::get_rounds(key_data, length);
+    schedule.s3_rounds = get_sbox_rounds(schedule.n_rounds);
+    stats.mark(catalyst::stats::counter::key_rounds, length);
+
+    schedule.s3_sbox = catalyst::SBox::get_sbox(schedule.s3_rounds);
+    schedule.s3_Isbox = catalyst::SBox::get_inverse_sbox(schedule.s3_rounds);
+    stats.mark(catalyst::stats::counter::key_sbox, length);
+
+    schedule.s3_transform_data = catalyst::SBox::get_transform(key_data, length);
+    stats.mark(catalyst::stats::counter::key_transform, length);
+
+    schedule.s5_keystream = std::make_unique<catalyst::cached_stream<catalyst::Xor::keystream>>(schedule.key.data(), schedule.key.size());
+
+    return schedule;
+}
+
+catalyst::key_context::key_context(uint8_t key_data[], size_t key_length)
+    : _schedule(std::make_shared<const catalyst::key_schedule>(catalyst::get_key_schedule(key_data, key_length))) {}
+catalyst::key_context::key_context(std::shared_ptr<const catalyst::key_schedule> schedule)
+    : _schedule(std::move(schedule)) {}
+
+const catalyst::key_schedule& catalyst::key_context::schedule() const {
+    return *_schedule;
+}
@@ -0,0 +1,370 @@
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include "catalyst_internal.hpp"
+#include "../catalyst.hpp"
+
+// every call to Pool::run is a job whose task indices are dealt out as one contiguous range per participant,
+// a participant works through its own range from the front and, once it is empty, steals the back half of
+// another participant's range, so a few slow tasks never leave the other threads idle
+namespace {
+    class job {
+    public:
+        job(size_t n, size_t participants, const std::function<void(size_t)>& f)
+            : _f(f), _slots(participants), _remaining(n) {
+            deal(n);
+        }
+        // a posted job, which keeps its tasks since nobody waits for it
+        job(size_t n, size_t participants, std::function<void(size_t)>&& f)
+            : _owned(std::move(f)), _f(_owned), _slots(participants), _remaining(n) {
+            deal(n);
+        }
+
+        // returns the participant index for the calling thread, or none once every range has an owner
+        bool join(size_t& p) {
+            p = _joined++;
+            return p < _slots.size();
+        }
+
+        void work(size_t p) {
+            size_t i;
+            while (take(p, i) || steal(p, i)) {
+                try {
+                    _f(i);
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(_done_mutex);
+                    if (!_error) {
+                        _error = std::current_exception();
+                    }
+                }
+
+                if (--_remaining == 0) {
+                    std::lock_guard<std::mutex> lock(_done_mutex);
+                    _done.notify_all();
+                }
+            }
+        }
+
+        // rethrows the first exception thrown by a task
+        void wait() {
+            std::unique_lock<std::mutex> lock(_done_mutex);
+            _done.wait(lock, [&]() { return _remaining == 0; });
+
+            if (_error) {
+                std::rethrow_exception(_error);
+            }
+        }
+    private:
+        struct slot {
+            std::mutex mutex;
+            size_t begin = 0;
+            size_t end = 0;
+        };
+
+        void deal(size_t n) {
+            for (size_t p = 0; p < _slots.size(); ++p) {
+                _slots[p].begin = n * p / _slots.size();
+                _slots[p].end = n * (p + 1) / _slots.size();
+            }
+        }
+
+        bool take(size_t p, size_t& i) {
+            slot& own = _slots[p];
+            std::lock_guard<std::mutex> lock(own.mutex);
+
+            if (own.begin == own.end) {
+                return false;
+            }
+            i = own.begin++;
+            return true;
+        }
+
+        bool steal(size_t p, size_t& i) {
+            for (size_t k = 1; k < _slots.size(); ++k) {
+                slot& victim = _slots[(p + k) % _slots.size()];
+
+                size_t begin, end;
+                {
+                    std::lock_guard<std::mutex> lock(victim.mutex);
+                    if (victim.begin == victim.end) {
+                        continue;
+                    }
+                    begin = victim.begin + (victim.end - victim.begin) / 2;
+                    end = victim.end;
+                    victim.end = begin;
+                }
+
+                slot& own = _slots[p];
+                std::lock_guard<std::mutex> lock(own.mutex);
+                own.begin = begin + 1;
+                own.end = end;
+
+                i = begin;
+                return true;
+            }
+            return false;
+        }
+
+        std::function<void(size_t)> _owned;
+        const std::function<void(size_t)>& _f;
+        std::vector<slot> _slots;
+        std::atomic<size_t> _joined = 0;
+        std::atomic<size_t> _remaining;
+
+        std::mutex _done_mutex;
+        std::condition_variable _done;
+        std::exception_ptr _error;
+    };
+
+    // <threads> - 1 workers, the thread calling run is the last participant
+    class thread_pool {
+    public:
+        // the workers already started are stopped again when one of them cannot be
+        explicit thread_pool(size_t threads) : _threads(threads) {
+            try {
+                for (size_t t = 1; t < threads; ++t) {
+                    _workers.emplace_back([this]() { worker(); });
+                }
+            }
+            catch (...) {
+                stop();
+                throw;
+            }
+        }
+        ~thread_pool() {
+            stop();
+        }
+
+        size_t threads() const {
+            return _threads;
+        }
+
+        void run(size_t n, const std::function<void(size_t)>& f, size_t max_threads) {
+            const size_t participants = std::min(n, max_threads == 0 ? _threads : std::min(max_threads, _threads));
+            if (participants <= 1) {
+                for (size_t i = 0; i < n; ++i) {
+                    f(i);
+                }
+                return;
+            }
+
+            const std::shared_ptr<job> j = std::make_shared<job>(n, participants, f);
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _jobs.push_back(j);
+            }
+            _wake.notify_all();
+
+            // a task calling run from a worker takes part in its own job, so nested calls always make progress
+            size_t p;
+            if (j->join(p)) {
+                j->work(p);
+            }
+            j->wait();
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            std::erase(_jobs, j);
+        }
+
+        // hands the tasks to the workers and returns at once, runs them itself when there are none
+        void post(size_t n, std::function<void(size_t)>&& f) {
+            const size_t participants = std::min(n, _workers.size());
+            if (participants == 0) {
+                for (size_t i = 0; i < n; ++i) {
+                    f(i);
+                }
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _jobs.push_back(std::make_shared<job>(n, participants, std::move(f)));
+            }
+            _wake.notify_all();
+        }
+    private:
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop = true;
+            }
+            _wake.notify_all();
+
+            for (auto& t : _workers) {
+                t.join();
+            }
+        }
+
+        void worker() {
+            std::unique_lock<std::mutex> lock(_mutex);
+
+            for (;;) {
+                _wake.wait(lock, [&]() { return _stop || !_jobs.empty(); });
+                // the posted jobs still queued are run before the pool goes
+                if (_jobs.empty()) {
+                    return;
+                }
+
+                const std::shared_ptr<job> j = _jobs.front();
+                size_t p;
+                if (!j->join(p)) {
+                    // every range has its owner, leave the job to them
+                    std::erase(_jobs, j);
+                    continue;
+                }
+
+                lock.unlock();
+                j->work(p);
+                lock.lock();
+            }
+        }
+
+        size_t _threads;
+        std::vector<std::thread> _workers;
+
+        std::mutex _mutex;
+        std::condition_variable _wake;
+        std::deque<std::shared_ptr<job>> _jobs;
+        bool _stop = false;
+    };
+
+    // CPUs this process may run on, capped by the cgroup CPU quota (containers often limit the
+    // quota without changing the visible CPU count)
+    size_t default_concurrency() {
+        size_t n = std::thread::hardware_concurrency();
+
+#if defined(__linux__)
+        cpu_set_t set;
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            n = CPU_COUNT(&set);
+        }
+
+        const auto cap = [&](uint64_t quota, uint64_t period) {
+            if (quota != 0 && period != 0) {
+                n = std::min<size_t>(n, (quota + period - 1) / period);
+            }
+        };
+
+        // cgroup v2: "<quota> <period>" or "max <period>"
+        std::ifstream v2("/sys/fs/cgroup/cpu.max");
+        std::string quota;
+        uint64_t period;
+        if (v2 >> quota >> period) {
+            if (quota != "max") {
+                cap(std::stoull(quota), period);
+            }
+        }
+        else {
+            // cgroup v1: a quota of -1 means no limit
+            std::ifstream v1_quota("/sys/fs/cgroup/cpu/cpu.cfs_quota_us");
+            std::ifstream v1_period("/sys/fs/cgroup/cpu/cpu.cfs_period_us");
+            int64_t v1_quota_us;
+            uint64_t v1_period_us;
+            if (v1_quota >> v1_quota_us && v1_period >> v1_period_us && v1_quota_us > 0) {
+                cap((uint64_t)v1_quota_us, v1_period_us);
+            }
+        }
+#endif
+
+        return std::max<size_t>(1, n);
+    }
+
+    // cap on the requested threads, as a multiple of the default, past it they only cost memory and switches
+    constexpr size_t max_oversubscription = 8;
+
+    std::mutex pool_mutex;
+    size_t requested_concurrency = 0;
+    std::shared_ptr<thread_pool> pool;
+
+    // a pool replaced by set_concurrency is destroyed once the last run using it returns
+    std::shared_ptr<thread_pool> get_pool() {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        if (!pool) {
+            const size_t default_threads = default_concurrency();
+            const size_t threads = requested_concurrency != 0 ? std::min(requested_concurrency, default_threads * max_oversubscription) : default_threads;
+            pool = std::make_shared<thread_pool>(threads);
+        }
+        return pool;
+    }
+}
+
+void catalyst::Pool::run(size_t n, const std::function<void(size_t)>& f, size_t max_threads) {
+    get_pool()->run(n, f, max_threads);
+}
+
+// message indices where the runs of about the same byte volume begin, the last one is <n>
+static std::vector<size_t> message_runs(size_t threads, size_t n, const std::function<size_t(size_t)>& length) {
+    // key schedule cost, counted as that many bytes of data
+    constexpr size_t message_overhead = 4096;
+    // tasks per thread, leaves room for the stealing to even out the runs
+    constexpr size_t tasks_per_thread = 8;
+
+    size_t total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        total += length(i) + message_overhead;
+    }
+    const size_t target = std::max(message_overhead, total / (threads * tasks_per_thread));
+
+    std::vector<size_t> bounds = { 0 };
+    for (size_t i = 0, volume = 0; i < n; ++i) {
+        volume += length(i) + message_overhead;
+        if (volume >= target || i + 1 == n) {
+            bounds.push_back(i + 1);
+            volume = 0;
+        }
+    }
+    return bounds;
+}
+
+void catalyst::Pool::run_messages(size_t n, const std::function<size_t(size_t)>& length, const std::function<void(size_t)>& f) {
+    const std::shared_ptr<thread_pool> p = get_pool();
+    const std::vector<size_t> bounds = message_runs(p->threads(), n, length);
+
+    p->run(bounds.size() - 1, [&](size_t t) {
+        for (size_t i = bounds[t]; i < bounds[t + 1]; ++i) {
+            f(i);
+        }
+    }, 0);
+}
+
+void catalyst::Pool::post_messages(size_t n, const std::function<size_t(size_t)>& length, std::function<void(size_t)> f) {
+    const std::shared_ptr<thread_pool> p = get_pool();
+    std::vector<size_t> bounds = message_runs(p->threads(), n, length);
+
+    const size_t runs = bounds.size() - 1;
+    p->post(runs, [bounds = std::move(bounds), f = std::move(f)](size_t t) {
+        for (size_t i = bounds[t]; i < bounds[t + 1]; ++i) {
+            f(i);
+        }
+    });
+}
+
+void catalyst::set_concurrency(size_t threads) {
+    // a replaced pool finishes its posted jobs when it goes, which may need get_pool, so not under pool_mutex
+    std::shared_ptr<thread_pool> replaced;
+
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    if (requested_concurrency != threads || !pool) {
+        requested_concurrency = threads;
+        replaced = std::move(pool);
+    }
+}
+size_t catalyst::concurrency() {
+    return get_pool()->threads();
+}
\ No newline at end of file
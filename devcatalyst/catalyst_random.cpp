@@ -0,0 +1,165 @@
+#include <iostream>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <span>
+
+#if defined(__unix__)
+#include <pthread.h>
+#endif
+
+#include "catalyst_internal.hpp"
+#include "../sha3/sha3.hpp"
+#include "../catalyst.hpp"
+
+// SHAKE256 DRBG: every refill squeezes SHAKE256(key) into the next key followed by a buffer of output,
+// so the state a thread holds never reveals the bytes it already handed out
+namespace {
+    class drbg {
+    public:
+        explicit drbg(std::span<const uint8_t> seed) {
+            reseed(seed);
+        }
+
+        // key = SHAKE256(key || input), drops what is left of the buffer
+        void reseed(std::span<const uint8_t> input) {
+            SHA3::SHAKE::context<256> sponge;
+            sponge.update(_key.data(), _key.size());
+            sponge.update(input.data(), input.size());
+            sponge.finalize();
+            sponge.squeeze(_key.data(), _key.size());
+            catalyst::Stats::count_hashes(catalyst::stats::counter::random, 1);
+
+            _used = _buffer.size();
+            _since_reseed = 0;
+        }
+
+        void generate(uint8_t* out, size_t n) {
+            while (n != 0) {
+                if (_used == _buffer.size()) {
+                    refill();
+                }
+
+                const size_t count = std::min(n, _buffer.size() - _used);
+                std::copy_n(_buffer.begin() + _used, count, out);
+                std::fill_n(_buffer.begin() + _used, count, 0);
+
+                _used += count;
+                out += count;
+                n -= count;
+            }
+        }
+
+        // bytes generated since the last reseed
+        size_t since_reseed() const {
+            return _since_reseed;
+        }
+    private:
+        void refill() {
+            SHA3::SHAKE::context<256> sponge;
+            sponge.update(_key.data(), _key.size());
+            sponge.finalize();
+            sponge.squeeze(_key.data(), _key.size());
+            sponge.squeeze(_buffer.data(), _buffer.size());
+            catalyst::Stats::count_hashes(catalyst::stats::counter::random, 1);
+
+            _used = 0;
+            _since_reseed += _buffer.size();
+        }
+
+        std::array<uint8_t, 64> _key = {};
+        std::array<uint8_t, 4096> _buffer = {};
+        size_t _used = 0;
+        size_t _since_reseed = 0;
+    };
+
+    // output of a thread's DRBG between two reseeds from the OS
+    constexpr size_t reseed_interval = 1 << 20;
+
+    std::array<uint8_t, 64> os_entropy() {
+        std::random_device rd;
+
+        std::array<uint8_t, 64> entropy;
+        for (size_t i = 0; i < entropy.size(); i += sizeof(uint32_t)) {
+            const uint32_t v = rd();
+            std::copy_n((const uint8_t*)&v, sizeof(v), entropy.begin() + i);
+        }
+        return entropy;
+    }
+
+    // bumped in the child after a fork, so that parent and child never share a DRBG output
+    std::atomic<uint64_t> fork_generation = 0;
+
+    void register_fork_handler() {
+#if defined(__unix__)
+        static std::once_flag once;
+        std::call_once(once, []() {
+            pthread_atfork(nullptr, nullptr, []() { ++fork_generation; });
+        });
+#endif
+    }
+
+    void thread_generate(uint8_t* out, size_t n) {
+        thread_local std::optional<drbg> generator;
+        thread_local uint64_t generation = 0;
+
+        const uint64_t current = fork_generation.load(std::memory_order_relaxed);
+        if (!generator) {
+            register_fork_handler();
+            generator.emplace(os_entropy());
+            generation = current;
+        }
+        else if (generation != current || generator->since_reseed() >= reseed_interval) {
+            generator->reseed(os_entropy());
+            generation = current;
+        }
+
+        generator->generate(out, n);
+    }
+
+    // a custom source is only looked up (under the lock) once one has been set
+    std::mutex source_mutex;
+    std::atomic<bool> custom_source = false;
+    std::shared_ptr<const catalyst::random_source> source;
+}
+
+void catalyst::Random::generate(uint8_t* out, size_t n) {
+    const catalyst::Stats::scope stats(catalyst::stats::counter::random, n);
+    if (!custom_source.load(std::memory_order_acquire)) {
+        thread_generate(out, n);
+        return;
+    }
+
+    std::shared_ptr<const catalyst::random_source> current;
+    {
+        std::lock_guard<std::mutex> lock(source_mutex);
+        current = source;
+    }
+
+    if (current) {
+        (*current)(out, n);
+    }
+    else {
+        thread_generate(out, n);
+    }
+}
+
+void catalyst::set_random_source(catalyst::random_source s) {
+    std::lock_guard<std::mutex> lock(source_mutex);
+    source = s ? std::make_shared<const catalyst::random_source>(std::move(s)) : nullptr;
+    custom_source.store(source != nullptr, std::memory_order_release);
+}
+
+void catalyst::set_random_seed(std::span<const uint8_t> seed) {
+    const auto generator = std::make_shared<drbg>(seed);
+    const auto mutex = std::make_shared<std::mutex>();
+
+    catalyst::set_random_source([generator, mutex](uint8_t* out, size_t n) {
+        std::lock_guard<std::mutex> lock(*mutex);
+        generator->generate(out, n);
+    });
+}
\ No newline at end of file
@@ -1,7 +1,6 @@
 #include <iostream>
 #include <array>
 #include <algorithm>
-#include <cmath>
 #include <cstdint>
 
 #include "catalyst_internal.hpp"
@@ -9,7 +8,6 @@
 
 namespace {
     constexpr size_t sbox_size = catalyst::SBox::sbox_size;
-    typedef std::array<std::array<uint8_t, sbox_size>, sbox_size> transform_matrix;
 
     // randomly generated (see: https://gist.github.com/AProgrammablePhoenix/e4b1d78dad93da0d36dab93c0683302a)
     // non-linearity: 98
@@ -51,55 +49,128 @@ namespace {
         0xb1, 0x3f, 0xe2, 0x4c, 0xfd, 0xa6, 0x10, 0x1c, 0xad, 0xf4, 0xc9, 0x4f, 0x19, 0x17, 0x04, 0x95
     };
 
-    constexpr transform_matrix matmul(uint8_t key_data[], size_t length) {
-        transform_matrix result = { 0 };
-        
-        std::vector<uint8_t> normalized_key;
-        normalized_key.reserve(sbox_size);
-        
-        if (length == sbox_size) {
-            normalized_key.insert(normalized_key.end(), key_data, key_data + length);
+    typedef std::array<std::array<uint8_t, sbox_size>, catalyst::SBox::max_rounds + 1> sbox_powers;
+
+    // powers[r][x] = sbox applied r times to x
+    constexpr sbox_powers compose(const std::array<uint8_t, sbox_size>& sbox) {
+        sbox_powers powers = { 0 };
+
+        for (size_t x = 0; x < sbox_size; ++x) {
+            powers[0][x] = (uint8_t)x;
         }
-        else if (length < sbox_size) {
-            normalized_key.insert(normalized_key.end(), key_data, key_data + length);
-            while (normalized_key.size() < sbox_size) {
-                const uint8_t padding = key_data[key_data[length - 1] % length];
-                normalized_key.emplace_back(padding);
+        for (size_t r = 1; r < powers.size(); ++r) {
+            for (size_t x = 0; x < sbox_size; ++x) {
+                powers[r][x] = sbox[powers[r - 1][x]];
             }
         }
-        else {
-            for (size_t i = 0; i < length; i += length / 4) {
-                constexpr size_t block_size = sbox_size / 4;
 
-                std::vector<uint8_t> digest;
-                digest.resize(block_size);
-                SHA3::SHAKE256(key_data + i, length / 4, digest.data(), block_size);
+        return powers;
+    }
 
-                normalized_key.insert(normalized_key.end(), digest.cbegin(), digest.cend());
-            }
+    constexpr sbox_powers base_sbox_powers = compose(base_sbox);
+    constexpr sbox_powers inverse_base_sbox_powers = compose(inverse_base_sbox);
+
+    struct substitute_kernel {
+        const char* name;
+        size_t(*substitute)(uint8_t*, size_t, const uint8_t*);
+    };
+
+    substitute_kernel select_substitute() {
+#if defined(CATALYST_HAVE_AVX512)
+        if (__builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vbmi")) {
+            return { "avx512vbmi", &catalyst::SBox::substitute_avx512vbmi };
+        }
+#endif
+#if defined(CATALYST_HAVE_AVX2)
+        if (__builtin_cpu_supports("avx2")) {
+            return { "avx2", &catalyst::SBox::substitute_avx2 };
         }
+#endif
+        // substitute_ssse3 (16 pshufb per 16 bytes) is slower than the scalar lookups, it is only
+        // kept for the bench
+        return { "scalar", &catalyst::SBox::substitute_scalar };
+    }
+
+    const substitute_kernel& get_substitute() {
+        static const substitute_kernel kernel = select_substitute();
+        return kernel;
+    }
+
+    // key stretched or hashed to sbox_size bytes
+    std::array<uint8_t, sbox_size> normalize_key(const uint8_t key_data[], size_t length) {
+        std::array<uint8_t, sbox_size> normalized_key = { 0 };
+
+        if (length == 0) {
+            // nothing to repeat, the key stays zeroed
+        }
+        else if (length <= sbox_size) {
+            std::copy_n(key_data, length, normalized_key.begin());
+
+            const uint8_t padding = key_data[key_data[length - 1] % length];
+            std::fill(normalized_key.begin() + length, normalized_key.end(), padding);
+        }
+        else {
+            // each quarter of the key is hashed into a quarter of the normalized key, the four hashes are
+            // independent so they go through the multi-buffer SHAKE256 together
+            // (when length % 4 != 0, the trailing bytes used to go through a fifth hash whose output was never read)
+            constexpr size_t n_blocks = 4;
+            constexpr size_t block_size = sbox_size / n_blocks;
 
-        for (size_t i = 0; i < sbox_size; ++i) {
-            for (size_t j = 0; j < sbox_size; ++j) {
-                result[i][j] = base_sbox[i] * normalized_key[j];
+            const uint8_t* blocks[n_blocks];
+            size_t blocks_length[n_blocks];
+            uint8_t* digests[n_blocks];
+            for (size_t i = 0; i < n_blocks; ++i) {
+                blocks[i] = key_data + i * (length / n_blocks);
+                blocks_length[i] = length / n_blocks;
+                digests[i] = normalized_key.data() + i * block_size;
             }
+
+            // SHAKE256 output used to be capped at 32 bytes, the rest of each block is kept zeroed
+            // so that transforms (and ciphers) made with long keys stay the same
+            SHA3::batch::SHAKE256(n_blocks, blocks, blocks_length, digests, std::min<size_t>(block_size, 32));
+            catalyst::Stats::count_hashes(catalyst::stats::counter::key_transform, n_blocks);
         }
 
-        return result;
+        return normalized_key;
+    }
+
+    // the transform used to be read from the matrix M[i][j] = base_sbox[i] * normalized_key[j] (mod 256),
+    // only the few entries it reads are computed
+    constexpr uint8_t transform_entry(const std::array<uint8_t, sbox_size>& normalized_key, uint8_t i, uint8_t j) {
+        return (uint8_t)(base_sbox[i] * normalized_key[j]);
     }
 
-    constexpr std::array<uint8_t, 3> getShiftVector(const transform_matrix& tm, uint8_t shift) {
+    constexpr std::array<uint8_t, 3> getShiftVector(const std::array<uint8_t, sbox_size>& normalized_key, uint8_t shift) {
         std::array<uint8_t, 3> v = { 0 };
 
-        v[0] = tm[0][shift];
-        v[1] = tm[shift][0];
-        v[2] = tm[v[0]][v[1]];
+        v[0] = transform_entry(normalized_key, 0, shift);
+        v[1] = transform_entry(normalized_key, shift, 0);
+        v[2] = transform_entry(normalized_key, v[0], v[1]);
 
         return v;
     }
 
+    // floor(sqrt(n)), bit by bit
+    constexpr uint32_t isqrt(uint32_t n) {
+        uint32_t root = 0;
+
+        for (uint32_t bit = 1u << 30; bit != 0; bit >>= 2) {
+            if (n >= root + bit) {
+                n -= root + bit;
+                root = (root >> 1) + bit;
+            }
+            else {
+                root >>= 1;
+            }
+        }
+
+        return root;
+    }
+    static_assert(isqrt(0) == 0 && isqrt(3) == 1 && isqrt(4) == 2 && isqrt(3 * 255 * 255) == 441);
+
+    // the norm goes up to 441, it used to be truncated to 8 bits through the floating point sqrt
     constexpr uint8_t getShift(const std::array<uint8_t, 3>& shift_vector) {
-        return (uint8_t)sqrt(
+        return (uint8_t)isqrt(
             shift_vector[0] * shift_vector[0] +
             shift_vector[1] * shift_vector[1] +
             shift_vector[2] * shift_vector[2]
@@ -113,17 +184,37 @@ const std::array<uint8_t, sbox_size>& catalyst::SBox::get_sbox() {
 const std::array<uint8_t, sbox_size>& catalyst::SBox::get_inverse_sbox() {
     return inverse_base_sbox;
 }
+const std::array<uint8_t, sbox_size>& catalyst::SBox::get_sbox(size_t rounds) {
+    return base_sbox_powers.at(rounds);
+}
+const std::array<uint8_t, sbox_size>& catalyst::SBox::get_inverse_sbox(size_t rounds) {
+    return inverse_base_sbox_powers.at(rounds);
+}
 std::array<uint8_t, sbox_size> catalyst::SBox::get_transform(uint8_t key_data[], uint64_t length) {
     std::array<uint8_t, sbox_size> transform_v = { 0 };
     
-    const transform_matrix transform_matrix = matmul(key_data, length);
-    const std::array<uint8_t, 3> genesis_v = getShiftVector(transform_matrix, 0);
+    const std::array<uint8_t, sbox_size> normalized_key = normalize_key(key_data, length);
+    const std::array<uint8_t, 3> genesis_v = getShiftVector(normalized_key, 0);
     transform_v[0] = getShift(genesis_v);
 
     for (size_t i = 1; i < sbox_size; ++i) {
-        const std::array<uint8_t, 3> shift_v = getShiftVector(transform_matrix, transform_v[i - 1] + i);
+        const std::array<uint8_t, 3> shift_v = getShiftVector(normalized_key, transform_v[i - 1] + i);
         transform_v[i] = getShift(shift_v);
     }
 
     return transform_v;
-}
\ No newline at end of file
+}
+
+size_t catalyst::SBox::substitute_scalar(uint8_t* data, size_t n, const uint8_t table[sbox_size]) {
+    for (size_t i = 0; i < n; ++i) {
+        data[i] = table[data[i]];
+    }
+    return n;
+}
+void catalyst::SBox::substitute(uint8_t* data, size_t n, const std::array<uint8_t, sbox_size>& table) {
+    const size_t done = get_substitute().substitute(data, n, table.data());
+    substitute_scalar(data + done, n - done, table.data());
+}
+const char* catalyst::SBox::substitute_implementation() {
+    return get_substitute().name;
+}
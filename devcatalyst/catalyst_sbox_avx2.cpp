@@ -0,0 +1,31 @@
+#include <immintrin.h>
+
+#include "catalyst_internal.hpp"
+
+// built with -mavx2, only called after checking that the CPU supports it
+
+// same row selection as the SSSE3 kernel, each row broadcast to both 128 bits halves
+size_t catalyst::SBox::substitute_avx2(uint8_t* data, size_t n, const uint8_t table[sbox_size]) {
+    __m256i rows[16];
+    for (size_t k = 0; k < 16; ++k) {
+        rows[k] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(table + 16 * k)));
+    }
+
+    const __m256i select = _mm256_set1_epi8(0x70);
+    const __m256i row_step = _mm256_set1_epi8(0x10);
+
+    size_t i = 0;
+    for (; i + sizeof(__m256i) <= n; i += sizeof(__m256i)) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(data + i));
+
+        __m256i r[4] = { _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256() };
+        for (size_t k = 0; k < 16; ++k) {
+            r[k % 4] = _mm256_or_si256(r[k % 4], _mm256_shuffle_epi8(rows[k], _mm256_adds_epu8(x, select)));
+            x = _mm256_sub_epi8(x, row_step);
+        }
+
+        _mm256_storeu_si256((__m256i*)(data + i), _mm256_or_si256(_mm256_or_si256(r[0], r[1]), _mm256_or_si256(r[2], r[3])));
+    }
+
+    return i;
+}
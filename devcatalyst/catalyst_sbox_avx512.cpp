@@ -0,0 +1,26 @@
+#include <immintrin.h>
+
+#include "catalyst_internal.hpp"
+
+// built with -mavx512f -mavx512bw -mavx512vbmi, only called after checking that the CPU supports them
+
+// vpermi2b looks 128 entries up at once from the low 7 bits, the two halves of the table
+// are looked up and the top bit of each byte picks the half
+size_t catalyst::SBox::substitute_avx512vbmi(uint8_t* data, size_t n, const uint8_t table[sbox_size]) {
+    const __m512i t0 = _mm512_loadu_si512(table);
+    const __m512i t1 = _mm512_loadu_si512(table + 64);
+    const __m512i t2 = _mm512_loadu_si512(table + 128);
+    const __m512i t3 = _mm512_loadu_si512(table + 192);
+
+    size_t i = 0;
+    for (; i + sizeof(__m512i) <= n; i += sizeof(__m512i)) {
+        const __m512i x = _mm512_loadu_si512(data + i);
+
+        const __m512i low = _mm512_permutex2var_epi8(t0, x, t1);
+        const __m512i high = _mm512_permutex2var_epi8(t2, x, t3);
+
+        _mm512_storeu_si512(data + i, _mm512_mask_blend_epi8(_mm512_movepi8_mask(x), low, high));
+    }
+
+    return i;
+}
@@ -0,0 +1,33 @@
+#include <immintrin.h>
+
+#include "catalyst_internal.hpp"
+
+// built with -mssse3, only called after checking that the CPU supports it
+
+// the table is cut in 16 rows of 16 bytes and pshufb looks the low nibble up in every row: adding 0x70 with
+// saturation keeps the low nibble and sets the top bit (pshufb then gives 0) of every byte whose high nibble
+// is not 0, the high nibble is brought to 0 one row after the other so each byte only gets its own row
+size_t catalyst::SBox::substitute_ssse3(uint8_t* data, size_t n, const uint8_t table[sbox_size]) {
+    __m128i rows[16];
+    for (size_t k = 0; k < 16; ++k) {
+        rows[k] = _mm_loadu_si128((const __m128i*)(table + 16 * k));
+    }
+
+    const __m128i select = _mm_set1_epi8(0x70);
+    const __m128i row_step = _mm_set1_epi8(0x10);
+
+    size_t i = 0;
+    for (; i + sizeof(__m128i) <= n; i += sizeof(__m128i)) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(data + i));
+
+        __m128i r[4] = { _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128() };
+        for (size_t k = 0; k < 16; ++k) {
+            r[k % 4] = _mm_or_si128(r[k % 4], _mm_shuffle_epi8(rows[k], _mm_adds_epu8(x, select)));
+            x = _mm_sub_epi8(x, row_step);
+        }
+
+        _mm_storeu_si128((__m128i*)(data + i), _mm_or_si128(_mm_or_si128(r[0], r[1]), _mm_or_si128(r[2], r[3])));
+    }
+
+    return i;
+}
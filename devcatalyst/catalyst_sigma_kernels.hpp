@@ -0,0 +1,132 @@
+#pragma once
+
+#include <iostream>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <array>
+
+#include "catalyst_internal.hpp"
+
+// stage 2 over whole words with the sigma fixed at compile time, written as plain loops over blocks of 32 words
+// (one period of the constants) that the compiler vectorizes, the target-specific translation units
+// instantiate them for the instruction set they are built for
+
+namespace catalyst {
+    namespace sigmas {
+        namespace {
+            template<int r0, int r1, int r2, bool shift> inline uint32_t sigma_rotations(uint32_t x) {
+                return std::rotr(x, r0) ^ std::rotr(x, r1) ^ (shift ? x >> r2 : std::rotr(x, r2));
+            }
+
+            template<size_t index> inline uint32_t sigma(uint32_t x) {
+                if constexpr (index == 0) {
+                    return sigma_rotations<7, 18, 3, true>(x);
+                }
+                else if constexpr (index == 1) {
+                    return sigma_rotations<17, 19, 10, true>(x);
+                }
+                else if constexpr (index == 2) {
+                    return sigma_rotations<2, 13, 22, false>(x);
+                }
+                else {
+                    return sigma_rotations<6, 11, 25, false>(x);
+                }
+            }
+
+            template<size_t index> inline uint32_t Isigma(uint32_t x) {
+                const byte_sliced_table& table = inverse_tables[index];
+                return table[0][x & 0xff] ^ table[1][(x >> 8) & 0xff] ^ table[2][(x >> 16) & 0xff] ^ table[3][x >> 24];
+            }
+
+            inline uint32_t load_big_endian(const uint8_t* in) {
+                uint32_t v;
+                std::memcpy(&v, in, sizeof(v));
+                if constexpr (std::endian::native == std::endian::little) {
+                    v = std::byteswap(v);
+                }
+                return v;
+            }
+            inline void store_big_endian(uint8_t* out, uint32_t v) {
+                if constexpr (std::endian::native == std::endian::little) {
+                    v = std::byteswap(v);
+                }
+                std::memcpy(out, &v, sizeof(v));
+            }
+
+            constexpr size_t block_words = 32;
+
+            // constants for the words of a block, starting at word <first_word> of the message
+            inline void block_constants(uint32_t c[block_words], const std::array<uint32_t, 32>& constants, size_t first_word) {
+                for (size_t j = 0; j < block_words; ++j) {
+                    c[j] = constants[(first_word + j) % 32];
+                }
+            }
+
+            // word i = sigma(big endian word i + constant), stored back in native order
+            template<size_t index> void mix_words(uint8_t* data, size_t n_words, size_t first_word, const std::array<uint32_t, 32>& constants) {
+                uint32_t c[block_words];
+                block_constants(c, constants, first_word);
+
+                size_t i = 0;
+                for (; i + block_words <= n_words; i += block_words) {
+                    uint32_t w[block_words];
+                    std::memcpy(w, data + i * sizeof(uint32_t), sizeof(w));
+                    for (size_t j = 0; j < block_words; ++j) {
+                        if constexpr (std::endian::native == std::endian::little) {
+                            w[j] = std::byteswap(w[j]);
+                        }
+                        w[j] = sigma<index>(w[j] + c[j]);
+                    }
+                    std::memcpy(data + i * sizeof(uint32_t), w, sizeof(w));
+                }
+                for (size_t j = 0; i < n_words; ++i, ++j) {
+                    uint8_t* const word = data + i * sizeof(uint32_t);
+                    const uint32_t v = sigma<index>(load_big_endian(word) + c[j]);
+                    std::memcpy(word, &v, sizeof(v));
+                }
+            }
+            template<size_t index> void unmix_words(uint8_t* data, size_t n_words, size_t first_word, const std::array<uint32_t, 32>& constants) {
+                uint32_t c[block_words];
+                block_constants(c, constants, first_word);
+
+                size_t i = 0;
+                for (; i + block_words <= n_words; i += block_words) {
+                    uint32_t w[block_words];
+                    std::memcpy(w, data + i * sizeof(uint32_t), sizeof(w));
+                    for (size_t j = 0; j < block_words; ++j) {
+                        w[j] = Isigma<index>(w[j]) - c[j];
+                        if constexpr (std::endian::native == std::endian::little) {
+                            w[j] = std::byteswap(w[j]);
+                        }
+                    }
+                    std::memcpy(data + i * sizeof(uint32_t), w, sizeof(w));
+                }
+                for (size_t j = 0; i < n_words; ++i, ++j) {
+                    uint8_t* const word = data + i * sizeof(uint32_t);
+                    uint32_t v;
+                    std::memcpy(&v, word, sizeof(v));
+                    store_big_endian(word, Isigma<index>(v) - c[j]);
+                }
+            }
+
+            // one switch per call, the loops run on the instantiation for the key's sigma
+            inline void mix_words(size_t index, uint8_t* data, size_t n_words, size_t first_word, const std::array<uint32_t, 32>& constants) {
+                switch (index) {
+                case 0: mix_words<0>(data, n_words, first_word, constants); break;
+                case 1: mix_words<1>(data, n_words, first_word, constants); break;
+                case 2: mix_words<2>(data, n_words, first_word, constants); break;
+                default: mix_words<3>(data, n_words, first_word, constants); break;
+                }
+            }
+            inline void unmix_words(size_t index, uint8_t* data, size_t n_words, size_t first_word, const std::array<uint32_t, 32>& constants) {
+                switch (index) {
+                case 0: unmix_words<0>(data, n_words, first_word, constants); break;
+                case 1: unmix_words<1>(data, n_words, first_word, constants); break;
+                case 2: unmix_words<2>(data, n_words, first_word, constants); break;
+                default: unmix_words<3>(data, n_words, first_word, constants); break;
+                }
+            }
+        }
+    }
+}
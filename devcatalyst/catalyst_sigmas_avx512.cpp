@@ -0,0 +1,10 @@
+#include "catalyst_sigma_kernels.hpp"
+
+// built with -mavx512f -mavx512bw, only called after checking that the CPU supports it
+
+void catalyst::sigmas::mix_avx512(size_t index, uint8_t* data, size_t n_words, size_t first_word, const std::array<uint32_t, 32>& constants) {
+    mix_words(index, data, n_words, first_word, constants);
+}
+void catalyst::sigmas::unmix_avx512(size_t index, uint8_t* data, size_t n_words, size_t first_word, const std::array<uint32_t, 32>& constants) {
+    unmix_words(index, data, n_words, first_word, constants);
+}
@@ -0,0 +1,121 @@
+#include <immintrin.h>
+
+#include "catalyst_sigma_kernels.hpp"
+
+// built with -mavx512f -mavx512bw -mavx512vbmi -mgfni, only called after checking that the CPU supports them
+
+// the inverse sigmas are 32x32 bit matrices over GF(2), seen as 4x4 blocks of 8x8 matrices: output byte i of a word
+// is the XOR over input byte j of M[i][j] * (byte j), which is what vgf2p8affineqb computes on every byte of a vector
+// with the same matrix, so 64 words are first transposed into 4 planes holding byte j of every word
+
+namespace {
+    typedef std::array<std::array<uint64_t, 16>, 4> affine_matrices;
+
+    // matrices[sigma][4 * i + j] = M[i][j] in the vgf2p8affineqb layout: byte 7 - b holds the row giving output bit b
+    constexpr affine_matrices make_matrices() {
+        affine_matrices matrices = {};
+
+        for (size_t s = 0; s < matrices.size(); ++s) {
+            for (size_t i = 0; i < 4; ++i) {
+                for (size_t j = 0; j < 4; ++j) {
+                    uint64_t m = 0;
+                    for (size_t b = 0; b < 8; ++b) {
+                        uint64_t row = 0;
+                        for (size_t a = 0; a < 8; ++a) {
+                            row |= (uint64_t)((catalyst::sigmas::singleton_inverses[s][8 * j + a] >> (8 * i + b)) & 1) << a;
+                        }
+                        m |= row << (8 * (7 - b));
+                    }
+                    matrices[s][4 * i + j] = m;
+                }
+            }
+        }
+
+        return matrices;
+    }
+    constexpr affine_matrices matrices = make_matrices();
+
+    // vpermi2b indices, <f>(k) for the 64 result bytes
+    template<typename F> __m512i byte_indices(F f) {
+        alignas(64) uint8_t idx[64];
+        for (size_t k = 0; k < 64; ++k) {
+            idx[k] = (uint8_t)f(k);
+        }
+        return _mm512_load_si512(idx);
+    }
+}
+
+void catalyst::sigmas::unmix_gfni(size_t index, uint8_t* data, size_t n_words, size_t first_word, const std::array<uint32_t, 32>& constants) {
+    constexpr size_t vector_words = sizeof(__m512i) / sizeof(uint32_t);
+    constexpr size_t group_words = 4 * vector_words;
+
+    // words -> planes: bytes 0, 1 (then 2, 3) of 32 words, then byte j of 64 words out of two of those
+    const __m512i to_pairs_01 = byte_indices([](size_t k) { return 4 * (k % 32) + k / 32; });
+    const __m512i to_pairs_23 = byte_indices([](size_t k) { return 4 * (k % 32) + k / 32 + 2; });
+    const __m512i to_plane_0 = byte_indices([](size_t k) { return (k / 32) * 64 + k % 32; });
+    const __m512i to_plane_1 = byte_indices([](size_t k) { return (k / 32) * 64 + k % 32 + 32; });
+    // planes -> words
+    const __m512i to_words_0 = byte_indices([](size_t k) { return (k % 4 / 2) * 64 + (k % 2) * 32 + k / 4; });
+    const __m512i to_words_1 = byte_indices([](size_t k) { return (k % 4 / 2) * 64 + (k % 2) * 32 + k / 4 + 16; });
+
+    const __m512i bswap = byte_indices([](size_t k) { return (k & ~size_t(3)) + 3 - k % 4; });
+
+    __m512i m[16];
+    for (size_t i = 0; i < 16; ++i) {
+        m[i] = _mm512_set1_epi64((long long)matrices[index][i]);
+    }
+
+    uint32_t c[block_words];
+    block_constants(c, constants, first_word);
+    const __m512i c_low = _mm512_loadu_si512(c);
+    const __m512i c_high = _mm512_loadu_si512(c + vector_words);
+
+    size_t w = 0;
+    for (; w + group_words <= n_words; w += group_words) {
+        uint8_t* const block = data + w * sizeof(uint32_t);
+
+        const __m512i z0 = _mm512_loadu_si512(block);
+        const __m512i z1 = _mm512_loadu_si512(block + 64);
+        const __m512i z2 = _mm512_loadu_si512(block + 128);
+        const __m512i z3 = _mm512_loadu_si512(block + 192);
+
+        const __m512i u0 = _mm512_permutex2var_epi8(z0, to_pairs_01, z1);
+        const __m512i u1 = _mm512_permutex2var_epi8(z0, to_pairs_23, z1);
+        const __m512i v0 = _mm512_permutex2var_epi8(z2, to_pairs_01, z3);
+        const __m512i v1 = _mm512_permutex2var_epi8(z2, to_pairs_23, z3);
+
+        const __m512i p[4] = {
+            _mm512_permutex2var_epi8(u0, to_plane_0, v0),
+            _mm512_permutex2var_epi8(u0, to_plane_1, v0),
+            _mm512_permutex2var_epi8(u1, to_plane_0, v1),
+            _mm512_permutex2var_epi8(u1, to_plane_1, v1)
+        };
+
+        __m512i q[4];
+        for (size_t i = 0; i < 4; ++i) {
+            q[i] = _mm512_xor_si512(
+                _mm512_xor_si512(_mm512_gf2p8affine_epi64_epi8(p[0], m[4 * i], 0), _mm512_gf2p8affine_epi64_epi8(p[1], m[4 * i + 1], 0)),
+                _mm512_xor_si512(_mm512_gf2p8affine_epi64_epi8(p[2], m[4 * i + 2], 0), _mm512_gf2p8affine_epi64_epi8(p[3], m[4 * i + 3], 0))
+            );
+        }
+
+        const __m512i u0_ = _mm512_permutex2var_epi8(q[0], to_plane_0, q[1]);
+        const __m512i v0_ = _mm512_permutex2var_epi8(q[0], to_plane_1, q[1]);
+        const __m512i u1_ = _mm512_permutex2var_epi8(q[2], to_plane_0, q[3]);
+        const __m512i v1_ = _mm512_permutex2var_epi8(q[2], to_plane_1, q[3]);
+
+        // a group is two periods of the constants
+        const __m512i words[4] = {
+            _mm512_sub_epi32(_mm512_permutex2var_epi8(u0_, to_words_0, u1_), c_low),
+            _mm512_sub_epi32(_mm512_permutex2var_epi8(u0_, to_words_1, u1_), c_high),
+            _mm512_sub_epi32(_mm512_permutex2var_epi8(v0_, to_words_0, v1_), c_low),
+            _mm512_sub_epi32(_mm512_permutex2var_epi8(v0_, to_words_1, v1_), c_high)
+        };
+
+        for (size_t i = 0; i < 4; ++i) {
+            _mm512_storeu_si512(block + 64 * i, _mm512_shuffle_epi8(words[i], bswap));
+        }
+    }
+
+    unmix_words(index, data + w * sizeof(uint32_t), n_words - w, first_word + w, constants);
+}
@@ -1,287 +1,271 @@
-#include <iostream>
-#include <string>
-#include <bit>
-#include <cmath>
-#include <thread>
-#include <array>
-#include <vector>
-
-#include "catalyst_internal.hpp"
-#include "../catalyst.hpp"
-
-using namespace catalyst::constants;
-
-namespace {
-    void stage1(catalyst::state& state) {
-        const std::vector<uint32_t>& constants_set = state.s1_constants;
-        const size_t n_constants = constants_set.size() * sizeof(uint32_t);
-
-        std::vector<uint8_t> cipher;
-
-        for (uint64_t i = 0; i < state.plain.size(); ++i) {
-            cipher.push_back(state.plain[i] + ((uint8_t*)constants_set.data())[i % n_constants]);
-        }
-
-        state.cipher = cipher;
-    }
-    void Istage1(catalyst::state& state) {
-        const std::vector<uint32_t>& constants_set = state.s1_constants;
-        const size_t n_constants = constants_set.size() * sizeof(uint32_t);
-        std::vector<uint8_t> plain;
-
-        for (uint64_t i = 0; i < state.cipher.size(); ++i) {
-            plain.push_back(state.cipher[i] - ((uint8_t*)constants_set.data())[i % n_constants]);
-        }
-
-        state.plain = plain;
-    }
-
-    void stage2(catalyst::state& state) {
-        const std::array<uint32_t, 32>& constants_set = state.s2_constants;
-        uint32_t(*const sigma)(uint32_t) = state.s2_transform;
-
-        auto& cipher = state.cipher;
-
-        size_t i = 0;
-        for (; i < cipher.size() / sizeof(uint32_t); ++i) {
-            uint32_t* const ptr = (uint32_t*)&cipher[i * sizeof(uint32_t)];
-
-            if constexpr (std::endian::native == std::endian::little) {
-                *ptr = std::byteswap(*ptr);
-            }
-
-            *ptr = sigma(*ptr + constants_set[i % 32]);
-        }
-        for (i *= sizeof(uint32_t); i < cipher.size(); ++i) {
-            cipher[i] += (uint8_t)sigma(constants_set[i % 32]);
-        }
-    }
-    void Istage2(catalyst::state& state) {
-        const std::array<uint32_t, 32>& constants_set = state.s2_constants;
-        uint32_t(*const sigma)(uint32_t) = state.s2_transform;
-        uint32_t(*const Isigma)(uint32_t) = state.s2_Itransform;
-
-        auto& cipher = state.cipher;
-        
-        size_t i = 0;
-        for (i = 0; i < cipher.size() / sizeof(uint32_t); ++i) {
-            uint32_t* ptr = (uint32_t*)&cipher[i * sizeof(uint32_t)];
-            *ptr = Isigma(*ptr);
-            *ptr -= constants_set[i % 32];
-
-            if constexpr (std::endian::native == std::endian::little) {
-                *ptr = std::byteswap(*ptr);
-            }
-        }
-        for (i *= sizeof(uint32_t); i < cipher.size(); ++i) {
-            cipher[i] -= (uint8_t)sigma(constants_set[i % 32]);
-        }
-    }
-
-    void stage3(catalyst::state& state) {
-        const bmp::cpp_int& key_n = state.key_n;
-        const size_t n_rounds = state.n_rounds;
-        const size_t rounds = 1 + std::ceil(std::log2(n_rounds));
-
-        const std::array<uint8_t, catalyst::SBox::sbox_size>& sbox = state.s3_sbox;
-        const std::array<uint8_t, catalyst::SBox::sbox_size>& transform_v = state.s3_transform_data;
-
-        auto& cipher = state.cipher;
-
-        for (size_t i = 0; i < rounds; ++i) {
-            for (auto& e : cipher) {
-                e = sbox[e];
-            }
-            std::rotate(cipher.begin(), cipher.begin() + 1, cipher.end());
-        }        
-        for (size_t i = 0; i < cipher.size(); ++i) {
-            cipher[i] += transform_v[i % catalyst::SBox::sbox_size];
-        }
-    }
-    void Istage3(catalyst::state& state) {
-        const std::array<uint8_t, catalyst::SBox::sbox_size>& Isbox = state.s3_Isbox;
-        const std::array<uint8_t, catalyst::SBox::sbox_size>& transform_v = state.s3_transform_data;
-
-        auto& cipher = state.cipher;
-
-        for (size_t i = 0; i < cipher.size(); ++i) {
-            cipher[i] -= transform_v[i % catalyst::SBox::sbox_size];
-        }
-        
-        const bmp::cpp_int& key_n = state.key_n;
-        const size_t n_rounds = state.n_rounds;
-        const size_t rounds = 1 + std::ceil(std::log2(n_rounds));        
-
-        for (size_t i = 0; i < rounds; ++i) {
-            for (auto& e : cipher) {
-                e = Isbox[e];
-            }
-            std::rotate(cipher.rbegin(), cipher.rbegin() + 1, cipher.rend());
-        }
-    }
-
-    void stage4(catalyst::state& state) {
-        const std::vector<uint8_t>& extension = state.s4_random_bytes;
-        state.cipher.insert(state.cipher.end(), extension.cbegin(), extension.cend());
-    }
-    void Istage4(catalyst::state& state) {
-        const uint8_t extension_size = state.cipher.back();
-        state.cipher.resize(state.cipher.size() - extension_size - 1);
-    }
-
-    // involution (apply it on the resulting cipher to get its state before the transformation)
-    void stage5(catalyst::state& state) {
-        const size_t n = state.cipher.size();
-
-        const std::vector<uint8_t> xor_transform = state.s5_transform_data;
-        for (size_t i = 0; i < n; ++i) {
-            state.cipher[i] ^= xor_transform[i];
-        }
-    }
-
-    catalyst::state get_state_encryption(uint8_t plain_data[], size_t plain_length, uint8_t key_data[], size_t key_length) {
-        catalyst::state state;
-
-        state.plain = std::vector<uint8_t>(plain_data, plain_data + plain_length);
-
-        state.s1_constants = extend_constants(get_constants_set(key_data, key_length), plain_length);
-
-        state.s2_constants = sigma::get_constants_set(key_data, key_length);
-        state.s2_transform = catalyst::sigmas::get_sigma(key_data, key_length);
-        state.s2_Itransform = catalyst::sigmas::get_Isigma(key_data, key_length);
-
-        state.s3_sbox = catalyst::SBox::get_sbox();
-        state.s3_Isbox = catalyst::SBox::get_inverse_sbox();
-        state.s3_transform_data = catalyst::SBox::get_transform(key_data, key_length);
-
-        state.s4_random_bytes = catalyst::Extend::generate(plain_length, key_length);
-
-        state.s5_transform_data = catalyst::Xor::generate_transform(key_data, key_length, plain_length + state.s4_random_bytes.size());
-
-        state.key_n = catalyst::helper::bytes_to_int(
-            std::vector<uint8_t>(
-                key_data,
-                key_data + key_length
-            )
-        );
-        state.n_rounds = catalyst::helper::get_rounds(state.key_n);
-
-        return state;
-    }
-    catalyst::state get_partial_state_decryption(uint8_t cipher_data[], size_t cipher_length, uint8_t key_data[], size_t key_length) {
-        catalyst::state state;
-
-        state.cipher = std::vector<uint8_t>(cipher_data, cipher_data + cipher_length);
-
-        state.s2_constants = sigma::get_constants_set(key_data, key_length);
-        state.s2_transform = catalyst::sigmas::get_sigma(key_data, key_length);
-        state.s2_Itransform = catalyst::sigmas::get_Isigma(key_data, key_length);
-
-        state.s3_sbox = catalyst::SBox::get_sbox();
-        state.s3_Isbox = catalyst::SBox::get_inverse_sbox();
-        state.s3_transform_data = catalyst::SBox::get_transform(key_data, key_length);
-
-        state.s5_transform_data = catalyst::Xor::generate_transform(key_data, key_length, cipher_length);
-
-        state.key_n = catalyst::helper::bytes_to_int(
-            std::vector<uint8_t>(
-                key_data,
-                key_data + key_length
-            )
-        );
-        state.n_rounds = catalyst::helper::get_rounds(state.key_n);
-
-        return state;
-    }
-}
-
-std::vector<uint8_t> catalyst::encrypt(uint8_t plain_data[], size_t plain_length, uint8_t key_data[], size_t key_length) {
-    catalyst::state state = get_state_encryption(plain_data, plain_length, key_data, key_length);
-    
-    stage1(state);
-    stage2(state);
-    stage3(state);
-    stage4(state);
-    stage5(state);
-
-    return state.cipher;
-}
-std::vector<uint8_t> catalyst::decrypt(uint8_t cipher_data[], size_t cipher_length, uint8_t key_data[], size_t key_length) {
-    catalyst::state state = get_partial_state_decryption(cipher_data, cipher_length, key_data, key_length);
-
-    stage5(state);
-    Istage4(state);
-
-    state.s1_constants = extend_constants(get_constants_set(key_data, key_length), state.cipher.size());
-
-    Istage3(state);
-    Istage2(state);
-    Istage1(state);
-
-    return state.plain;
-}
-std::vector<uint8_t> catalyst::encrypt(const catalyst::input_data& data) {
-    return catalyst::encrypt(data.data, data.data_length, data.key, data.key_length);
-}
-std::vector<uint8_t> catalyst::decrypt(const catalyst::input_data& data) {
-    return catalyst::decrypt(data.data, data.data_length, data.key, data.key_length);
-}
-
-std::vector<std::vector<uint8_t>> catalyst::encrypt_serial(const std::vector<catalyst::input_data>& data_v) {
-    const size_t n = data_v.size();    
-    std::vector<std::vector<uint8_t>> result(n);
-
-    for (size_t i = 0; i < n; ++i) {
-        result[i] = encrypt(data_v[i]);
-    }
-
-    return result;
-}
-std::vector<std::vector<uint8_t>> catalyst::decrypt_serial(const std::vector<catalyst::input_data>& data_v) {
-    const size_t n = data_v.size();    
-    std::vector<std::vector<uint8_t>> result(n);
-
-    for (size_t i = 0; i < n; ++i) {
-        result[i] = decrypt(data_v[i]);
-    }
-
-    return result;
-}
-std::vector<std::vector<uint8_t>> catalyst::encrypt_serial_mt(const std::vector<catalyst::input_data>& data_v, const size_t n_block) {
-    const size_t n = data_v.size();
-    std::vector<std::vector<uint8_t>> result(n);
-    std::vector<std::thread> threads;
-    
-    for (size_t i = 0; i < n_block && i * n_block < n; ++i) {
-        threads.emplace_back([](const size_t i, const size_t n, const size_t n_block, const std::vector<catalyst::input_data>* const data_v, std::vector<uint8_t>* const out) {
-            for (size_t j = 0; j < n_block && j + i * n_block < n; ++j) {
-                *(out + j) = encrypt((*data_v)[j + i * n_block]);
-            }
-        }, i, n, n_block, &data_v, result.data() + n_block * i);
-    }
-
-    for (auto& t : threads) {
-        t.join();
-    }
-
-    return result;
-}
-std::vector<std::vector<uint8_t>> catalyst::decrypt_serial_mt(const std::vector<catalyst::input_data>& data_v, const size_t n_block) {
-    const size_t n = data_v.size();
-    std::vector<std::vector<uint8_t>> result(n);
-    std::vector<std::thread> threads;
-    
-    for (size_t i = 0; i < n_block && i * n_block < n; ++i) {
-        threads.emplace_back([](const size_t i, const size_t n, const size_t n_block, const std::vector<catalyst::input_data>* const data_v, std::vector<uint8_t>* const out) {
-            for (size_t j = 0; j < n_block && j + i * n_block < n; ++j) {
-                *(out + j) = decrypt((*data_v)[j + i * n_block]);
-            }
-        }, i, n, n_block, &data_v, result.data() + n_block * i);
-    }
-
-    for (auto& t : threads) {
-        t.join();
-    }
-
-    return result;
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <bit>
+#include <cmath>
+#include <array>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "catalyst_internal.hpp"
+#include "../catalyst.hpp"
+
+namespace {
+    // the SHAKE128 of every message key that its sigma index is drawn from, the keys going through the
+    // multi-buffer SHAKE128 SHA3::batch::width() at a time instead of one sponge each
+    std::vector<std::array<uint8_t, catalyst::sigmas::sigma_hash_size>> hash_sigma_keys(const std::vector<catalyst::input_data>& data_v) {
+        const size_t n = data_v.size();
+        std::vector<std::array<uint8_t, catalyst::sigmas::sigma_hash_size>> hashes(n);
+
+        std::vector<const uint8_t*> keys(n);
+        std::vector<size_t> keys_length(n);
+        std::vector<uint8_t*> digests(n);
+        for (size_t i = 0; i < n; ++i) {
+            keys[i] = data_v[i].key;
+            keys_length[i] = data_v[i].key_length;
+            digests[i] = hashes[i].data();
+        }
+
+        SHA3::batch::SHAKE128(n, keys.data(), keys_length.data(), digests.data(), catalyst::sigmas::sigma_hash_size);
+        catalyst::Stats::count_hashes(catalyst::stats::counter::key_sigma, n);
+
+        return hashes;
+    }
+
+    catalyst::key_context message_key(const catalyst::input_data& data, const std::array<uint8_t, catalyst::sigmas::sigma_hash_size>& sigma_hash) {
+        return catalyst::key_context(std::make_shared<const catalyst::key_schedule>(catalyst::get_key_schedule(data.key, data.key_length, sigma_hash.data())));
+    }
+}
+
+namespace catalyst::Staged {
+    // <out> may start at the same address as <in>
+    void stage1(std::span<const uint8_t> in, std::span<uint8_t> out, const catalyst::key_schedule& schedule) {
+        const catalyst::Stats::scope stats(catalyst::stats::counter::stage1, in.size());
+        catalyst::cached_stream<catalyst::constants::extension_stream, catalyst::constants::max_cached_chunks>::reader constants_stream(*schedule.s1_extended);
+
+        for (size_t i = 0; i < in.size(); ) {
+            const std::span<const uint8_t> constants = constants_stream.next(in.size() - i);
+            const size_t n = constants.size();
+
+            for (size_t j = 0; j < n; ++j, ++i) {
+                out[i] = in[i] + constants[j];
+            }
+        }
+    }
+    void Istage1(std::span<uint8_t> data, const catalyst::key_schedule& schedule) {
+        const catalyst::Stats::scope stats(catalyst::stats::counter::Istage1, data.size());
+        catalyst::cached_stream<catalyst::constants::extension_stream, catalyst::constants::max_cached_chunks>::reader constants_stream(*schedule.s1_extended);
+
+        for (size_t i = 0; i < data.size(); ) {
+            const std::span<const uint8_t> constants = constants_stream.next(data.size() - i);
+            const size_t n = constants.size();
+
+            for (size_t j = 0; j < n; ++j, ++i) {
+                data[i] -= constants[j];
+            }
+        }
+    }
+
+    void stage2(std::span<uint8_t> cipher, const catalyst::key_schedule& schedule) {
+        const catalyst::Stats::scope stats(catalyst::stats::counter::stage2, cipher.size());
+        const std::array<uint32_t, 32>& constants_set = schedule.s2_constants;
+        uint32_t(*const sigma)(uint32_t) = schedule.s2_transform;
+
+        const size_t n_words = cipher.size() / sizeof(uint32_t);
+        catalyst::sigmas::mix(schedule.s2_sigma, cipher.data(), n_words, 0, constants_set);
+
+        for (size_t i = n_words * sizeof(uint32_t); i < cipher.size(); ++i) {
+            cipher[i] += (uint8_t)sigma(constants_set[i % 32]);
+        }
+    }
+    void Istage2(std::span<uint8_t> cipher, const catalyst::key_schedule& schedule) {
+        const catalyst::Stats::scope stats(catalyst::stats::counter::Istage2, cipher.size());
+        const std::array<uint32_t, 32>& constants_set = schedule.s2_constants;
+        uint32_t(*const sigma)(uint32_t) = schedule.s2_transform;
+
+        const size_t n_words = cipher.size() / sizeof(uint32_t);
+        catalyst::sigmas::unmix(schedule.s2_sigma, cipher.data(), n_words, 0, constants_set);
+
+        for (size_t i = n_words * sizeof(uint32_t); i < cipher.size(); ++i) {
+            cipher[i] -= (uint8_t)sigma(constants_set[i % 32]);
+        }
+    }
+
+    // s3_rounds times (substitution, rotation by one) is one substitution through the composed sbox and one rotation
+    void stage3(std::span<uint8_t> cipher, const catalyst::key_schedule& schedule) {
+        const catalyst::Stats::scope stats(catalyst::stats::counter::stage3, cipher.size());
+        const std::array<uint8_t, catalyst::SBox::sbox_size>& sbox = schedule.s3_sbox;
+        const std::array<uint8_t, catalyst::SBox::sbox_size>& transform_v = schedule.s3_transform_data;
+
+        catalyst::SBox::substitute(cipher.data(), cipher.size(), sbox);
+        if (!cipher.empty()) {
+            std::rotate(cipher.begin(), cipher.begin() + schedule.s3_rounds % cipher.size(), cipher.end());
+        }
+        for (size_t i = 0; i < cipher.size(); ++i) {
+            cipher[i] += transform_v[i % catalyst::SBox::sbox_size];
+        }
+    }
+    void Istage3(std::span<uint8_t> cipher, const catalyst::key_schedule& schedule) {
+        const catalyst::Stats::scope stats(catalyst::stats::counter::Istage3, cipher.size());
+        const std::array<uint8_t, catalyst::SBox::sbox_size>& Isbox = schedule.s3_Isbox;
+        const std::array<uint8_t, catalyst::SBox::sbox_size>& transform_v = schedule.s3_transform_data;
+
+        for (size_t i = 0; i < cipher.size(); ++i) {
+            cipher[i] -= transform_v[i % catalyst::SBox::sbox_size];
+        }
+        if (!cipher.empty()) {
+            std::rotate(cipher.begin(), cipher.end() - schedule.s3_rounds % cipher.size(), cipher.end());
+        }
+        catalyst::SBox::substitute(cipher.data(), cipher.size(), Isbox);
+    }
+
+    // writes the random extension after the <plain_length> bytes already in <cipher>, returns the cipher length
+    size_t stage4(std::span<uint8_t> cipher, size_t plain_length, const catalyst::key_schedule& schedule) {
+        catalyst::Stats::scope stats(catalyst::stats::counter::stage4);
+        const std::vector<uint8_t> extension = catalyst::Extend::generate(plain_length, schedule.key.size());
+        std::copy(extension.cbegin(), extension.cend(), cipher.begin() + plain_length);
+        stats.add(extension.size());
+        return plain_length + extension.size();
+    }
+    // returns the length of <cipher> without its extension
+    size_t Istage4(std::span<const uint8_t> cipher) {
+        const catalyst::Stats::scope stats(catalyst::stats::counter::Istage4, cipher.size());
+        if (cipher.empty() || (size_t)cipher.back() + 1 > cipher.size()) {
+            throw std::runtime_error("catalyst: invalid cipher");
+        }
+        return cipher.size() - cipher.back() - 1;
+    }
+
+    // involution (apply it on the resulting cipher to get its state before the transformation),
+    // <out> may start at the same address as <in>
+    void stage5(std::span<const uint8_t> in, std::span<uint8_t> out, const catalyst::key_schedule& schedule) {
+        const catalyst::Stats::scope stats(catalyst::stats::counter::stage5, in.size());
+        catalyst::cached_stream<catalyst::Xor::keystream>::reader xor_stream(*schedule.s5_keystream);
+
+        for (size_t i = 0; i < in.size(); ) {
+            const std::span<const uint8_t> xor_transform = xor_stream.next(in.size() - i);
+            const size_t n = xor_transform.size();
+
+            for (size_t j = 0; j < n; ++j, ++i) {
+                out[i] = in[i] ^ xor_transform[j];
+            }
+        }
+    }
+}
+
+size_t catalyst::Staged::encrypt(std::span<const uint8_t> plain, std::span<uint8_t> cipher, const catalyst::key_schedule& schedule) {
+    const std::span<uint8_t> data = cipher.first(plain.size());
+    stage1(plain, data, schedule);
+    stage2(data, schedule);
+    stage3(data, schedule);
+
+    const size_t cipher_length = stage4(cipher, plain.size(), schedule);
+    stage5(cipher.first(cipher_length), cipher, schedule);
+
+    return cipher_length;
+}
+size_t catalyst::Staged::decrypt(std::span<const uint8_t> cipher, std::span<uint8_t> plain, const catalyst::key_schedule& schedule) {
+    stage5(cipher, plain, schedule);
+
+    const std::span<uint8_t> data = plain.first(Istage4(plain.first(cipher.size())));
+    Istage3(data, schedule);
+    Istage2(data, schedule);
+    Istage1(data, schedule);
+
+    return data.size();
+}
+size_t catalyst::encrypt(std::span<const uint8_t> plain, std::span<uint8_t> cipher, const catalyst::key_context& key) {
+    if (cipher.size() < catalyst::max_cipher_size(plain.size())) {
+        throw std::invalid_argument("catalyst::encrypt: output buffer smaller than catalyst::max_cipher_size");
+    }
+    const catalyst::Stats::scope stats(catalyst::stats::counter::encrypt, plain.size());
+    return catalyst::Fused::encrypt(plain, cipher, key.schedule());
+}
+size_t catalyst::decrypt(std::span<const uint8_t> cipher, std::span<uint8_t> plain, const catalyst::key_context& key) {
+    if (plain.size() < cipher.size()) {
+        throw std::invalid_argument("catalyst::decrypt: output buffer smaller than the cipher");
+    }
+    const catalyst::Stats::scope stats(catalyst::stats::counter::decrypt, cipher.size());
+    return catalyst::Fused::decrypt(cipher, plain, key.schedule());
+}
+size_t catalyst::decrypt(std::span<uint8_t> data, const catalyst::key_context& key) {
+    return catalyst::decrypt(data, data, key);
+}
+
+std::vector<uint8_t> catalyst::encrypt(const uint8_t plain_data[], size_t plain_length, const catalyst::key_context& key) {
+    std::vector<uint8_t> cipher(catalyst::max_cipher_size(plain_length));
+    cipher.resize(catalyst::encrypt({ plain_data, plain_length }, cipher, key));
+    return cipher;
+}
+std::vector<uint8_t> catalyst::decrypt(const uint8_t cipher_data[], size_t cipher_length, const catalyst::key_context& key) {
+    std::vector<uint8_t> plain(cipher_data, cipher_data + cipher_length);
+    plain.resize(catalyst::decrypt(plain, key));
+    return plain;
+}
+std::vector<uint8_t> catalyst::encrypt(uint8_t plain_data[], size_t plain_length, uint8_t key_data[], size_t key_length) {
+    return catalyst::encrypt(plain_data, plain_length, catalyst::key_context(key_data, key_length));
+}
+std::vector<uint8_t> catalyst::decrypt(uint8_t cipher_data[], size_t cipher_length, uint8_t key_data[], size_t key_length) {
+    return catalyst::decrypt(cipher_data, cipher_length, catalyst::key_context(key_data, key_length));
+}
+std::vector<uint8_t> catalyst::encrypt(const catalyst::input_data& data) {
+    return catalyst::encrypt(data.data, data.data_length, data.key, data.key_length);
+}
+std::vector<uint8_t> catalyst::decrypt(const catalyst::input_data& data) {
+    return catalyst::decrypt(data.data, data.data_length, data.key, data.key_length);
+}
+
+std::vector<std::vector<uint8_t>> catalyst::encrypt_serial(const std::vector<catalyst::input_data>& data_v) {
+    const size_t n = data_v.size();    
+    std::vector<std::vector<uint8_t>> result(n);
+
+    for (size_t i = 0; i < n; ++i) {
+        result[i] = encrypt(data_v[i]);
+    }
+
+    return result;
+}
+std::vector<std::vector<uint8_t>> catalyst::decrypt_serial(const std::vector<catalyst::input_data>& data_v) {
+    const size_t n = data_v.size();    
+    std::vector<std::vector<uint8_t>> result(n);
+
+    for (size_t i = 0; i < n; ++i) {
+        result[i] = decrypt(data_v[i]);
+    }
+
+    return result;
+}
+std::vector<std::vector<uint8_t>> catalyst::encrypt_serial_mt(const std::vector<catalyst::input_data>& data_v, const size_t) {
+    const auto sigma_hashes = hash_sigma_keys(data_v);
+
+    std::vector<std::vector<uint8_t>> result(data_v.size());
+    catalyst::Pool::run_messages(data_v.size(), [&](size_t i) { return data_v[i].data_length; }, [&](size_t i) {
+        result[i] = encrypt(data_v[i].data, data_v[i].data_length, message_key(data_v[i], sigma_hashes[i]));
+    });
+    return result;
+}
+std::vector<std::vector<uint8_t>> catalyst::decrypt_serial_mt(const std::vector<catalyst::input_data>& data_v, const size_t) {
+    const auto sigma_hashes = hash_sigma_keys(data_v);
+
+    std::vector<std::vector<uint8_t>> result(data_v.size());
+    catalyst::Pool::run_messages(data_v.size(), [&](size_t i) { return data_v[i].data_length; }, [&](size_t i) {
+        result[i] = decrypt(data_v[i].data, data_v[i].data_length, message_key(data_v[i], sigma_hashes[i]));
+    });
+    return result;
+}
+std::vector<std::vector<uint8_t>> catalyst::encrypt_serial_mt(const std::vector<std::span<const uint8_t>>& data_v, const catalyst::key_context& key) {
+    std::vector<std::vector<uint8_t>> result(data_v.size());
+    catalyst::Pool::run_messages(data_v.size(), [&](size_t i) { return data_v[i].size(); }, [&](size_t i) {
+        result[i] = encrypt(data_v[i].data(), data_v[i].size(), key);
+    });
+    return result;
+}
+std::vector<std::vector<uint8_t>> catalyst::decrypt_serial_mt(const std::vector<std::span<const uint8_t>>& data_v, const catalyst::key_context& key) {
+    std::vector<std::vector<uint8_t>> result(data_v.size());
+    catalyst::Pool::run_messages(data_v.size(), [&](size_t i) { return data_v[i].size(); }, [&](size_t i) {
+        result[i] = decrypt(data_v[i].data(), data_v[i].size(), key);
+    });
+    return result;
 }
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include <iostream>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "catalyst_internal.hpp"
+#include "../catalyst.hpp"
+
+#if defined(CATALYST_STATS)
+// every thread writes its own counters only (plain loads and stores, no locked instruction), readers sum the
+// counters of the live threads with what the exited ones left, and reset moves the baseline instead of
+// writing to the counters of other threads
+namespace {
+    constexpr size_t n_counters = (size_t)catalyst::stats::counter::count;
+
+    typedef std::array<catalyst::stats::values, n_counters> totals;
+
+    struct thread_counters {
+        std::array<std::atomic<uint64_t>, n_counters> calls = {};
+        std::array<std::atomic<uint64_t>, n_counters> bytes = {};
+        std::array<std::atomic<uint64_t>, n_counters> nanoseconds = {};
+        std::array<std::atomic<uint64_t>, n_counters> hashes = {};
+
+        void add_to(totals& t) const {
+            for (size_t c = 0; c < n_counters; ++c) {
+                t[c].calls += calls[c].load(std::memory_order_relaxed);
+                t[c].bytes += bytes[c].load(std::memory_order_relaxed);
+                t[c].nanoseconds += nanoseconds[c].load(std::memory_order_relaxed);
+                t[c].hashes += hashes[c].load(std::memory_order_relaxed);
+            }
+        }
+    };
+
+    struct registry {
+        std::mutex mutex;
+        std::vector<const thread_counters*> live;
+        totals exited = {};
+        totals baseline = {};
+
+        totals sum() const {
+            totals t = exited;
+            for (const thread_counters* counters : live) {
+                counters->add_to(t);
+            }
+            return t;
+        }
+    };
+
+    // never destroyed: pool workers are joined by the destructor of a static, after function-local statics
+    // built later than it are gone, and their thread_local registrations still need the registry on exit
+    registry& get_registry() {
+        static registry* const r = new registry;
+        return *r;
+    }
+
+    class registration {
+    public:
+        registration() {
+            registry& r = get_registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.live.push_back(&counters);
+        }
+        ~registration() {
+            registry& r = get_registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            counters.add_to(r.exited);
+            std::erase(r.live, &counters);
+        }
+
+        thread_counters counters;
+    };
+
+    thread_counters& local() {
+        thread_local registration r;
+        return r.counters;
+    }
+
+    // single writer, a relaxed load and store is enough
+    inline void bump(std::atomic<uint64_t>& counter, uint64_t n) {
+        if (n != 0) {
+            counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+    }
+}
+
+std::atomic<bool> catalyst::Stats::enabled = false;
+
+uint64_t catalyst::Stats::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void catalyst::Stats::add(catalyst::stats::counter c, uint64_t calls, uint64_t bytes, uint64_t nanoseconds, uint64_t hashes) {
+    thread_counters& counters = local();
+    bump(counters.calls[(size_t)c], calls);
+    bump(counters.bytes[(size_t)c], bytes);
+    bump(counters.nanoseconds[(size_t)c], nanoseconds);
+    bump(counters.hashes[(size_t)c], hashes);
+}
+
+bool catalyst::stats::available() {
+    return true;
+}
+
+void catalyst::stats::enable(bool on) {
+    catalyst::Stats::enabled.store(on, std::memory_order_relaxed);
+}
+bool catalyst::stats::enabled() {
+    return catalyst::Stats::active();
+}
+
+catalyst::stats::snapshot catalyst::stats::read() {
+    registry& r = get_registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    const totals t = r.sum();
+    catalyst::stats::snapshot s;
+    for (size_t c = 0; c < n_counters; ++c) {
+        s.counters[c].calls = t[c].calls - r.baseline[c].calls;
+        s.counters[c].bytes = t[c].bytes - r.baseline[c].bytes;
+        s.counters[c].nanoseconds = t[c].nanoseconds - r.baseline[c].nanoseconds;
+        s.counters[c].hashes = t[c].hashes - r.baseline[c].hashes;
+    }
+    return s;
+}
+
+void catalyst::stats::reset() {
+    registry& r = get_registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.baseline = r.sum();
+}
+#else
+bool catalyst::stats::available() {
+    return false;
+}
+
+void catalyst::stats::enable(bool) {}
+bool catalyst::stats::enabled() {
+    return false;
+}
+
+catalyst::stats::snapshot catalyst::stats::read() {
+    return {};
+}
+void catalyst::stats::reset() {}
+#endif
+
+const char* catalyst::stats::name(catalyst::stats::counter c) {
+    static const char* const names[] = {
+        "encrypt",
+        "decrypt",
+        "key_schedule",
+        "key_constants",
+        "key_sigma",
+        "key_rounds",
+        "key_sbox",
+        "key_transform",
+        "stage1",
+        "Istage1",
+        "stage2",
+        "Istage2",
+        "stage3",
+        "Istage3",
+        "stage4",
+        "Istage4",
+        "stage5",
+        "extend_constants",
+        "xor_keystream",
+        "random"
+    };
+    static_assert(std::size(names) == (size_t)catalyst::stats::counter::count);
+
+    return (size_t)c < std::size(names) ? names[(size_t)c] : "";
+}
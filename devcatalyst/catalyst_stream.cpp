@@ -0,0 +1,293 @@
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "catalyst_internal.hpp"
+#include "../sha3/sha3.hpp"
+#include "../catalyst.hpp"
+
+namespace {
+    constexpr uint8_t frame_key_domain[] = { 'c', 'a', 't', 'a', 'l', 'y', 's', 't', '.', 'f', 'r', 'a', 'm', 'e' };
+
+    void store_u32(uint8_t* out, uint32_t v) {
+        for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+            out[i] = (uint8_t)(v >> (8 * i));
+        }
+    }
+    uint32_t load_u32(const uint8_t* in) {
+        uint32_t v = 0;
+        for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+            v |= (uint32_t)in[i] << (8 * i);
+        }
+        return v;
+    }
+}
+
+// frame key = SHAKE256(master key || "catalyst.frame" || frame index as uint64 LE)
+catalyst::key_context catalyst::Frame::derive_key(const catalyst::key_schedule& master, uint64_t index) {
+    uint8_t index_bytes[sizeof(uint64_t)];
+    for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+        index_bytes[i] = (uint8_t)(index >> (8 * i));
+    }
+
+    SHA3::SHAKE::context<256> sponge;
+    sponge.update(master.key);
+    sponge.update(frame_key_domain, sizeof(frame_key_domain));
+    sponge.update(index_bytes, sizeof(index_bytes));
+    sponge.finalize();
+
+    uint8_t key[derived_key_size];
+    sponge.squeeze(key, derived_key_size);
+    catalyst::Stats::count_hashes(catalyst::stats::counter::key_schedule, 1);
+
+    return catalyst::key_context(key, derived_key_size);
+}
+
+std::array<uint8_t, catalyst::Frame::header_size> catalyst::Frame::make_header(uint32_t chunk_size) {
+    std::array<uint8_t, header_size> header = { 0 };
+    std::copy(std::begin(magic), std::end(magic), header.begin());
+    header[sizeof(magic)] = version;
+    store_u32(header.data() + sizeof(magic) + 1, chunk_size);
+    return header;
+}
+uint32_t catalyst::Frame::read_header(const uint8_t header[header_size]) {
+    if (!std::equal(std::begin(magic), std::end(magic), header) || header[sizeof(magic)] != version) {
+        throw std::runtime_error("catalyst: not a catalyst stream");
+    }
+
+    const uint32_t chunk_size = load_u32(header + sizeof(magic) + 1);
+    if (chunk_size == 0 || chunk_size > max_chunk_size) {
+        throw std::runtime_error("catalyst: invalid stream chunk size");
+    }
+    return chunk_size;
+}
+
+std::array<uint8_t, catalyst::Frame::frame_header_size> catalyst::Frame::make_frame_header(uint32_t cipher_length, bool final) {
+    std::array<uint8_t, frame_header_size> header = { 0 };
+    store_u32(header.data(), cipher_length | (final ? final_flag : 0));
+    return header;
+}
+uint32_t catalyst::Frame::read_frame_header(const uint8_t header[frame_header_size], bool& final) {
+    const uint32_t v = load_u32(header);
+    final = (v & final_flag) != 0;
+    return v & ~final_flag;
+}
+
+catalyst::encryptor::encryptor(const catalyst::key_context& key, catalyst::output_sink sink, size_t chunk_size)
+    : _key(key), _sink(std::move(sink)), _chunk_size(chunk_size)
+{
+    if (_chunk_size == 0 || _chunk_size > Frame::max_chunk_size) {
+        throw std::invalid_argument("catalyst::encryptor: invalid chunk size");
+    }
+
+    const auto header = Frame::make_header((uint32_t)_chunk_size);
+    _sink(header);
+}
+
+void catalyst::encryptor::write_frame(std::span<const uint8_t> chunk, bool final) {
+    std::vector<uint8_t> cipher;
+    if (!chunk.empty()) {
+        cipher = catalyst::encrypt(chunk.data(), chunk.size(), Frame::derive_key(_key.schedule(), _frame));
+    }
+    ++_frame;
+
+    const auto header = Frame::make_frame_header((uint32_t)cipher.size(), final);
+    _sink(header);
+    if (!cipher.empty()) {
+        _sink(cipher);
+    }
+}
+
+void catalyst::encryptor::update(std::span<const uint8_t> data) {
+    if (_finished) {
+        throw std::logic_error("catalyst::encryptor: update after finish");
+    }
+
+    // a full chunk is only written once more data follows it, the last frame has to carry the final flag
+    if (!_pending.empty()) {
+        const size_t n = std::min(data.size(), _chunk_size - _pending.size());
+        _pending.insert(_pending.end(), data.begin(), data.begin() + n);
+        data = data.subspan(n);
+
+        if (data.empty()) {
+            return;
+        }
+        write_frame(_pending, false);
+        _pending.clear();
+    }
+
+    while (data.size() > _chunk_size) {
+        write_frame(data.first(_chunk_size), false);
+        data = data.subspan(_chunk_size);
+    }
+    _pending.assign(data.begin(), data.end());
+}
+
+void catalyst::encryptor::finish() {
+    if (_finished) {
+        throw std::logic_error("catalyst::encryptor: finish called twice");
+    }
+
+    write_frame(_pending, true);
+    _pending.clear();
+    _pending.shrink_to_fit();
+    _finished = true;
+}
+
+catalyst::decryptor::decryptor(const catalyst::key_context& key, catalyst::output_sink sink)
+    : _key(key), _sink(std::move(sink)) {}
+
+void catalyst::decryptor::update(std::span<const uint8_t> data) {
+    while (!data.empty()) {
+        if (_final_read) {
+            throw std::runtime_error("catalyst: data after the final frame");
+        }
+
+        // bytes needed to complete what is currently being read (stream header, frame header or frame body)
+        size_t needed = 0;
+        if (!_header_read) {
+            needed = Frame::header_size;
+        }
+        else if (_pending.size() < Frame::frame_header_size) {
+            needed = Frame::frame_header_size;
+        }
+        else {
+            bool final = false;
+            const uint32_t cipher_length = Frame::read_frame_header(_pending.data(), final);
+
+            if (cipher_length > _chunk_size + Frame::max_extension) {
+                throw std::runtime_error("catalyst: invalid frame length");
+            }
+            needed = Frame::frame_header_size + cipher_length;
+        }
+
+        const size_t n = std::min(data.size(), needed - _pending.size());
+        _pending.insert(_pending.end(), data.begin(), data.begin() + n);
+        data = data.subspan(n);
+
+        if (_pending.size() < needed) {
+            return;
+        }
+
+        if (!_header_read) {
+            _chunk_size = Frame::read_header(_pending.data());
+            _header_read = true;
+            _pending.clear();
+            continue;
+        }
+
+        bool final = false;
+        const uint32_t cipher_length = Frame::read_frame_header(_pending.data(), final);
+        if (_pending.size() < Frame::frame_header_size + cipher_length) {
+            // only the frame header so far, its body comes next
+            continue;
+        }
+
+        if (cipher_length != 0) {
+            const std::span<uint8_t> frame = std::span<uint8_t>(_pending).subspan(Frame::frame_header_size);
+            const size_t plain_length = catalyst::decrypt(frame, Frame::derive_key(_key.schedule(), _frame));
+            _sink(frame.first(plain_length));
+        }
+
+        ++_frame;
+        _final_read = final;
+        _pending.clear();
+    }
+}
+
+void catalyst::decryptor::finish() {
+    if (!_final_read) {
+        throw std::runtime_error("catalyst: truncated stream");
+    }
+}
+
+std::vector<uint8_t> catalyst::encrypt_parallel(std::span<const uint8_t> data, const catalyst::key_context& key, size_t threads, size_t chunk_size) {
+    if (chunk_size == 0 || chunk_size > Frame::max_chunk_size) {
+        throw std::invalid_argument("catalyst::encrypt_parallel: invalid chunk size");
+    }
+
+    // the last frame is the one holding the end of the data (an empty final frame for empty data)
+    const size_t n_frames = std::max<size_t>(1, (data.size() + chunk_size - 1) / chunk_size);
+    std::vector<std::vector<uint8_t>> ciphers(n_frames);
+
+    catalyst::Pool::run(n_frames, [&](size_t i) {
+        const std::span<const uint8_t> chunk = data.subspan(i * chunk_size, std::min(chunk_size, data.size() - i * chunk_size));
+        if (!chunk.empty()) {
+            ciphers[i] = catalyst::encrypt(chunk.data(), chunk.size(), Frame::derive_key(key.schedule(), i));
+        }
+    }, threads);
+
+    size_t total = Frame::header_size;
+    for (const auto& c : ciphers) {
+        total += Frame::frame_header_size + c.size();
+    }
+
+    std::vector<uint8_t> out;
+    out.reserve(total);
+
+    const auto header = Frame::make_header((uint32_t)chunk_size);
+    out.insert(out.end(), header.begin(), header.end());
+    for (size_t i = 0; i < n_frames; ++i) {
+        const auto frame_header = Frame::make_frame_header((uint32_t)ciphers[i].size(), i + 1 == n_frames);
+        out.insert(out.end(), frame_header.begin(), frame_header.end());
+        out.insert(out.end(), ciphers[i].begin(), ciphers[i].end());
+        std::vector<uint8_t>().swap(ciphers[i]);
+    }
+
+    return out;
+}
+
+std::vector<uint8_t> catalyst::decrypt_parallel(std::span<const uint8_t> data, const catalyst::key_context& key, size_t threads) {
+    if (data.size() < Frame::header_size) {
+        throw std::runtime_error("catalyst: truncated stream");
+    }
+    const size_t chunk_size = Frame::read_header(data.data());
+
+    // frame boundaries only depend on the frame headers, find them all before decrypting anything
+    std::vector<std::span<const uint8_t>> frames;
+    bool final = false;
+    for (size_t offset = Frame::header_size; !final; ) {
+        if (data.size() - offset < Frame::frame_header_size) {
+            throw std::runtime_error("catalyst: truncated stream");
+        }
+
+        const uint32_t cipher_length = Frame::read_frame_header(data.data() + offset, final);
+        offset += Frame::frame_header_size;
+
+        if (cipher_length > chunk_size + Frame::max_extension) {
+            throw std::runtime_error("catalyst: invalid frame length");
+        }
+        if (data.size() - offset < cipher_length) {
+            throw std::runtime_error("catalyst: truncated stream");
+        }
+
+        frames.push_back(data.subspan(offset, cipher_length));
+        offset += cipher_length;
+
+        if (final && offset != data.size()) {
+            throw std::runtime_error("catalyst: data after the final frame");
+        }
+    }
+
+    std::vector<std::vector<uint8_t>> plains(frames.size());
+    catalyst::Pool::run(frames.size(), [&](size_t i) {
+        if (!frames[i].empty()) {
+            plains[i] = catalyst::decrypt(frames[i].data(), frames[i].size(), Frame::derive_key(key.schedule(), i));
+        }
+    }, threads);
+
+    size_t total = 0;
+    for (const auto& p : plains) {
+        total += p.size();
+    }
+
+    std::vector<uint8_t> out;
+    out.reserve(total);
+    for (auto& p : plains) {
+        out.insert(out.end(), p.begin(), p.end());
+        std::vector<uint8_t>().swap(p);
+    }
+
+    return out;
+}
\ No newline at end of file
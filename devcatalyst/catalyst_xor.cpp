@@ -1,52 +1,56 @@
-#include <iostream>
-#include <vector>
-
-#include "catalyst_internal.hpp"
-#include "../sha3/sha3.hpp"
-
-std::vector<uint8_t> catalyst::Xor::generate_transform(uint8_t key_data[], uint64_t length, uint64_t n) {
-    std::vector<uint8_t> xor_transform;
-    xor_transform.reserve(n);
-
-    if (length >= n) {
-        for (size_t i = 0; i < n; ++i) {
-            xor_transform.emplace_back(key_data[i]);
-        }
-        return xor_transform;
-    }
-
-    for (size_t i = 0; i < length; ++i) {
-        xor_transform.emplace_back(key_data[i]);
-    }
-
-    constexpr size_t digest_size = 32;
-    uint8_t key_digest[digest_size];
-
-    SHA3::SHA3_256(key_data, length, key_digest);
-    for (size_t i = 0; i < digest_size; ++i) {
-        xor_transform.emplace_back(key_digest[i]);
-    }
-
-    const size_t round_size = length > digest_size ? digest_size : length;
-    
-    while (xor_transform.size() < n) {
-        uint8_t* const prev = std::max(xor_transform.data(), xor_transform.data() + xor_transform.size() - 2 * digest_size);
-        uint8_t* const prev_hash = xor_transform.data() - digest_size;
-
-        std::vector<uint8_t> round_data;
-        round_data.resize(round_size);
-        for (size_t i = 0; i < round_size; ++i) {
-            round_data[i] = prev[i] & prev_hash[i];
-        }
-
-        uint8_t round_hash[digest_size];
-        SHA3::SHA3_256(round_data.data(), round_size, round_hash);
-
-        for (size_t i = 0; i < digest_size; ++i) {
-            xor_transform.emplace_back(round_hash[i]);
-        }
-    }
-
-    xor_transform.resize(n);
-    return xor_transform;
+#include <iostream>
+#include <algorithm>
+#include <vector>
+
+#include "catalyst_internal.hpp"
+#include "../sha3/sha3.hpp"
+
+// the transform starts with the key, then SHA3-256 of the key, then every block is the hash of
+// (block before the previous one & previous block), so only the last two blocks have to be kept
+catalyst::Xor::keystream::keystream(const uint8_t key_data[], uint64_t length)
+    : _key(key_data), _length(length), _round_size(length > digest_size ? digest_size : length) {}
+
+std::span<const uint8_t> catalyst::Xor::keystream::next() {
+    if (!_key_read) {
+        _key_read = true;
+        if (_length != 0) {
+            return { _key, _length };
+        }
+    }
+
+    if (!_hash_read) {
+        _hash_read = true;
+        const catalyst::Stats::scope stats(catalyst::stats::counter::xor_keystream, _hash.size(), 1);
+
+        // the block before the first hash is the end of the key (its start for keys shorter than a hash)
+        std::copy(_key + _length - _round_size, _key + _length, _prev.begin());
+        SHA3::SHA3_256(_key, _length, _hash.data());
+
+        return _hash;
+    }
+
+    const catalyst::Stats::scope stats(catalyst::stats::counter::xor_keystream, _hash.size(), 1);
+    uint8_t round_data[digest_size];
+    for (size_t i = 0; i < _round_size; ++i) {
+        round_data[i] = _prev[i] & _hash[i];
+    }
+
+    _prev = _hash;
+    SHA3::SHA3_256(round_data, _round_size, _hash.data());
+
+    return _hash;
+}
+
+std::vector<uint8_t> catalyst::Xor::generate_transform(const uint8_t key_data[], uint64_t length, uint64_t n) {
+    std::vector<uint8_t> xor_transform;
+    xor_transform.reserve(n);
+
+    keystream stream(key_data, length);
+    while (xor_transform.size() < n) {
+        const std::span<const uint8_t> block = stream.next();
+        const size_t count = std::min<uint64_t>(block.size(), n - xor_transform.size());
+        xor_transform.insert(xor_transform.end(), block.begin(), block.begin() + count);
+    }
+
+    return xor_transform;
 }
\ No newline at end of file
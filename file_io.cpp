@@ -0,0 +1,269 @@
+#include <iostream>
+#include <cerrno>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CATALYST_CLI_MMAP
+#endif
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#include "file_io.hpp"
+
+namespace {
+    [[noreturn]] void read_error(const std::string& filename) {
+        throw std::runtime_error("Unable to read file: " + filename);
+    }
+    [[noreturn]] void write_error(const std::string& filename) {
+        throw std::runtime_error("Unable to write output to file: " + filename);
+    }
+
+    // outputs are written next to their destination then renamed over it, so that an output file that is also
+    // the input (decrypting "x.out" writes "x.out") is only replaced once the input has been read entirely
+    std::string temporary_name(const std::string& filename) {
+        return filename + ".tmp";
+    }
+    void replace(const std::string& temporary, const std::string& filename) {
+        std::error_code ec;
+        std::filesystem::rename(temporary, filename, ec);
+        if (ec) {
+            std::filesystem::remove(temporary, ec);
+            write_error(filename);
+        }
+    }
+}
+
+input_file::input_file(const std::string& filename) {
+#if defined(CATALYST_CLI_MMAP)
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1) {
+        read_error(filename);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        read_error(filename);
+    }
+    _size = (size_t)st.st_size;
+
+    // nothing to map in an empty file
+    if (_size != 0) {
+        void* const mapping = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            read_error(filename);
+        }
+        madvise(mapping, _size, MADV_SEQUENTIAL);
+        _data = (const uint8_t*)mapping;
+    }
+    close(fd);
+#else
+    std::ifstream input_data_file(filename, std::ios::binary);
+    if (!input_data_file) {
+        read_error(filename);
+    }
+
+    _buffer.resize(std::filesystem::file_size(filename));
+    input_data_file.read((char*)_buffer.data(), _buffer.size());
+    _data = _buffer.data();
+    _size = _buffer.size();
+#endif
+}
+
+input_file::~input_file() {
+#if defined(CATALYST_CLI_MMAP)
+    if (_size != 0) {
+        munmap((void*)_data, _size);
+    }
+#endif
+}
+
+std::span<const uint8_t> input_file::data() const {
+    return { _data, _size };
+}
+
+void input_file::prefetch() const {
+#if defined(CATALYST_CLI_MMAP)
+    if (_size != 0) {
+        madvise((void*)_data, _size, MADV_WILLNEED);
+    }
+#endif
+}
+
+output_file::output_file(const std::string& filename, size_t max_size) : _filename(filename), _size(max_size) {
+#if defined(CATALYST_CLI_MMAP)
+    _fd = open(temporary_name(filename).c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (_fd == -1) {
+        write_error(filename);
+    }
+
+    if (_size != 0) {
+        void* mapping = MAP_FAILED;
+        if (ftruncate(_fd, (off_t)_size) == 0) {
+            mapping = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+        }
+        if (mapping == MAP_FAILED) {
+            close(_fd);
+            std::filesystem::remove(temporary_name(filename));
+            write_error(filename);
+        }
+        _data = (uint8_t*)mapping;
+    }
+#else
+    _buffer.resize(max_size);
+    _data = _buffer.data();
+#endif
+}
+
+output_file::~output_file() {
+#if defined(CATALYST_CLI_MMAP)
+    if (_size != 0) {
+        munmap(_data, _size);
+    }
+    if (_fd != -1) {
+        close(_fd);
+    }
+#endif
+
+    if (!_committed) {
+        std::error_code ec;
+        std::filesystem::remove(temporary_name(_filename), ec);
+    }
+}
+
+std::span<uint8_t> output_file::data() {
+    return { _data, _size };
+}
+
+void output_file::commit(size_t size) {
+#if defined(CATALYST_CLI_MMAP)
+    if (_size != 0) {
+        munmap(_data, _size);
+        _size = 0;
+    }
+
+    const bool written = ftruncate(_fd, (off_t)size) == 0;
+    const bool closed = close(_fd) == 0;
+    _fd = -1;
+
+    if (!written || !closed) {
+        write_error(_filename);
+    }
+    replace(temporary_name(_filename), _filename);
+#else
+    write_file(_filename, std::span<const uint8_t>(_buffer).first(size));
+#endif
+
+    _committed = true;
+}
+
+void write_file(const std::string& filename, std::span<const uint8_t> data) {
+    const std::string temporary = temporary_name(filename);
+
+#if defined(CATALYST_CLI_MMAP)
+    const int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        write_error(filename);
+    }
+
+    // a single write unless the kernel returns early
+    size_t written = 0;
+    while (written < data.size()) {
+        const ssize_t n = write(fd, data.data() + written, data.size() - written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            close(fd);
+            std::filesystem::remove(temporary);
+            write_error(filename);
+        }
+        written += (size_t)n;
+    }
+
+    if (close(fd) != 0) {
+        std::filesystem::remove(temporary);
+        write_error(filename);
+    }
+#else
+    {
+        std::ofstream output_f(temporary, std::ios::binary);
+        if (!output_f.write((const char*)data.data(), data.size()) || !output_f.flush()) {
+            output_f.close();
+            std::filesystem::remove(temporary);
+            write_error(filename);
+        }
+    }
+#endif
+
+    replace(temporary, filename);
+}
+
+std::vector<uint8_t> read_descriptor(int fd) {
+    std::vector<uint8_t> data;
+#if defined(CATALYST_CLI_MMAP)
+    uint8_t buffer[4096];
+    for (;;) {
+        const ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            throw std::runtime_error("Unable to read file descriptor: " + std::to_string(fd));
+        }
+        if (n == 0) {
+            return data;
+        }
+        data.insert(data.end(), buffer, buffer + n);
+    }
+#else
+    throw std::runtime_error("Reading from a file descriptor is not supported on this platform");
+#endif
+}
+
+namespace {
+    // stdin and stdout carry binary data, no newline translation
+    void set_binary_stdio() {
+#if defined(_WIN32)
+        static const bool done = (_setmode(_fileno(stdin), _O_BINARY), _setmode(_fileno(stdout), _O_BINARY), true);
+        (void)done;
+#endif
+    }
+}
+
+size_t read_stdin(std::span<uint8_t> buffer) {
+    set_binary_stdio();
+
+    size_t read = 0;
+    while (read < buffer.size()) {
+        const size_t n = std::fread(buffer.data() + read, 1, buffer.size() - read, stdin);
+        if (n == 0) {
+            if (std::ferror(stdin)) {
+                throw std::runtime_error("Unable to read the standard input");
+            }
+            break;
+        }
+        read += n;
+    }
+    return read;
+}
+
+void write_stdout(std::span<const uint8_t> data) {
+    set_binary_stdio();
+
+    if (std::fwrite(data.data(), 1, data.size(), stdout) != data.size()) {
+        throw std::runtime_error("Unable to write to the standard output");
+    }
+}
\ No newline at end of file
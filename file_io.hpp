@@ -0,0 +1,55 @@
+#pragma once
+
+#include <iostream>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// whole file mapped read-only in memory (read into a buffer where mmap is not available)
+class input_file {
+public:
+    explicit input_file(const std::string& filename);
+    ~input_file();
+    input_file(const input_file&) = delete;
+    input_file& operator=(const input_file&) = delete;
+
+    std::span<const uint8_t> data() const;
+    // starts reading the whole file in the background
+    void prefetch() const;
+private:
+    const uint8_t* _data = nullptr;
+    size_t _size = 0;
+    std::vector<uint8_t> _buffer;
+};
+
+// file of at most <max_size> bytes written in place through a shared mapping, cut down to its final size by commit,
+// which only then puts it in place of <filename> (nothing is written if it is destroyed before, e.g. when decryption fails)
+class output_file {
+public:
+    output_file(const std::string& filename, size_t max_size);
+    ~output_file();
+    output_file(const output_file&) = delete;
+    output_file& operator=(const output_file&) = delete;
+
+    std::span<uint8_t> data();
+    void commit(size_t size);
+private:
+    std::string _filename;
+    uint8_t* _data = nullptr;
+    size_t _size = 0;
+    int _fd = -1;
+    std::vector<uint8_t> _buffer;
+    bool _committed = false;
+};
+
+// writes <data> to <filename> with a single write, replacing it once done
+void write_file(const std::string& filename, std::span<const uint8_t> data);
+
+// everything that can be read from the file descriptor <fd>, until its end
+std::vector<uint8_t> read_descriptor(int fd);
+
+// binary standard input / output: read_stdin fills <buffer> unless the input ends first and returns the number
+// of bytes read, write_stdout writes the whole of <data>, both throw std::runtime_error on failure
+size_t read_stdin(std::span<uint8_t> buffer);
+void write_stdout(std::span<const uint8_t> data);
@@ -1,52 +1,77 @@
-#include <iostream>
-#include <vector>
-
-#include "sha3_internal.hpp"
-#include "sha3.hpp"
-
-uint8_t SHA3::SHA3_224(const uint8_t* data, size_t len, uint8_t* digest) {
-    return SHA3::internal::internal_sha3<224, 38>(data, len, digest);
-}
-uint8_t SHA3::SHA3_224(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest) {
-    digest.resize(28);
-    return SHA3::internal::internal_sha3<224, 28>(data.data(), data.size(), digest.data());
-}
-
-uint8_t SHA3::SHA3_256(const uint8_t* data, size_t len, uint8_t* digest) {
-    return SHA3::internal::internal_sha3<256, 32>(data, len, digest);
-}
-uint8_t SHA3::SHA3_256(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest) {
-    digest.resize(32);
-    return SHA3::internal::internal_sha3<256, 32>(data.data(), data.size(), digest.data());
-}
-
-uint8_t SHA3::SHA3_384(const uint8_t* data, size_t len, uint8_t* digest) {
-    return SHA3::internal::internal_sha3<384, 48>(data, len, digest);
-}
-uint8_t SHA3::SHA3_384(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest) {
-    digest.resize(48);
-    return SHA3::internal::internal_sha3<384, 48>(data.data(), data.size(), digest.data());
-}
-
-uint8_t SHA3::SHA3_512(const uint8_t* data, size_t len, uint8_t* digest) {
-    return SHA3::internal::internal_sha3<512, 64>(data, len, digest);
-}
-uint8_t SHA3::SHA3_512(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest) {
-    digest.resize(64);
-    return SHA3::internal::internal_sha3<512, 64>(data.data(), data.size(), digest.data());
-}
-
-uint8_t SHA3::SHAKE128(const uint8_t* data, size_t len, uint8_t* digest, size_t digest_len) {
-    return SHA3::internal::internal_sha3XOF<128>(data, len, digest, digest_len);
-}
-uint8_t SHA3::SHAKE128(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest, size_t digest_len) {
-    return SHA3::internal::internal_sha3XOF<128>(data.data(), data.size(), digest.data(), digest_len);
-}
-
-uint8_t SHA3::SHAKE256(const uint8_t* data, size_t len, uint8_t* digest, size_t digest_len) {
-    return SHA3::internal::internal_sha3XOF<256>(data, len, digest, digest_len);
-}
-uint8_t SHA3::SHAKE256(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest, size_t digest_len) {
-    digest.resize(digest_len);
-    return SHA3::internal::internal_sha3XOF<256>(data.data(), data.size(), digest.data(), digest_len);
+#include <iostream>
+#include <vector>
+
+#include "sha3_internal.hpp"
+#include "sha3.hpp"
+
+uint8_t SHA3::SHA3_224(const uint8_t* data, size_t len, uint8_t* digest) {
+    return SHA3::internal::internal_sha3<224, 38>(data, len, digest);
+}
+uint8_t SHA3::SHA3_224(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest) {
+    digest.resize(28);
+    return SHA3::internal::internal_sha3<224, 28>(data.data(), data.size(), digest.data());
+}
+
+uint8_t SHA3::SHA3_256(const uint8_t* data, size_t len, uint8_t* digest) {
+    return SHA3::internal::internal_sha3<256, 32>(data, len, digest);
+}
+uint8_t SHA3::SHA3_256(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest) {
+    digest.resize(32);
+    return SHA3::internal::internal_sha3<256, 32>(data.data(), data.size(), digest.data());
+}
+
+uint8_t SHA3::SHA3_384(const uint8_t* data, size_t len, uint8_t* digest) {
+    return SHA3::internal::internal_sha3<384, 48>(data, len, digest);
+}
+uint8_t SHA3::SHA3_384(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest) {
+    digest.resize(48);
+    return SHA3::internal::internal_sha3<384, 48>(data.data(), data.size(), digest.data());
+}
+
+uint8_t SHA3::SHA3_512(const uint8_t* data, size_t len, uint8_t* digest) {
+    return SHA3::internal::internal_sha3<512, 64>(data, len, digest);
+}
+uint8_t SHA3::SHA3_512(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest) {
+    digest.resize(64);
+    return SHA3::internal::internal_sha3<512, 64>(data.data(), data.size(), digest.data());
+}
+
+uint8_t SHA3::SHAKE128(const uint8_t* data, size_t len, uint8_t* digest, size_t digest_len) {
+    return SHA3::internal::internal_sha3XOF<128>(data, len, digest, digest_len);
+}
+uint8_t SHA3::SHAKE128(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest, size_t digest_len) {
+    digest.resize(digest_len);
+    return SHA3::internal::internal_sha3XOF<128>(data.data(), data.size(), digest.data(), digest_len);
+}
+
+uint8_t SHA3::SHAKE256(const uint8_t* data, size_t len, uint8_t* digest, size_t digest_len) {
+    return SHA3::internal::internal_sha3XOF<256>(data, len, digest, digest_len);
+}
+uint8_t SHA3::SHAKE256(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest, size_t digest_len) {
+    digest.resize(digest_len);
+    return SHA3::internal::internal_sha3XOF<256>(data.data(), data.size(), digest.data(), digest_len);
+}
+
+size_t SHA3::batch::width() {
+    return SHA3::internal::internal_multi_width();
+}
+
+uint8_t SHA3::batch::SHA3_224(size_t n, const uint8_t* const data[], const size_t len[], uint8_t* const digest[]) {
+    return SHA3::internal::internal_sha3_multi(n, data, len, digest, 28, 224, false);
+}
+uint8_t SHA3::batch::SHA3_256(size_t n, const uint8_t* const data[], const size_t len[], uint8_t* const digest[]) {
+    return SHA3::internal::internal_sha3_multi(n, data, len, digest, 32, 256, false);
+}
+uint8_t SHA3::batch::SHA3_384(size_t n, const uint8_t* const data[], const size_t len[], uint8_t* const digest[]) {
+    return SHA3::internal::internal_sha3_multi(n, data, len, digest, 48, 384, false);
+}
+uint8_t SHA3::batch::SHA3_512(size_t n, const uint8_t* const data[], const size_t len[], uint8_t* const digest[]) {
+    return SHA3::internal::internal_sha3_multi(n, data, len, digest, 64, 512, false);
+}
+
+uint8_t SHA3::batch::SHAKE128(size_t n, const uint8_t* const data[], const size_t len[], uint8_t* const digest[], size_t digest_len) {
+    return SHA3::internal::internal_sha3_multi(n, data, len, digest, digest_len, 128, true);
+}
+uint8_t SHA3::batch::SHAKE256(size_t n, const uint8_t* const data[], const size_t len[], uint8_t* const digest[], size_t digest_len) {
+    return SHA3::internal::internal_sha3_multi(n, data, len, digest, digest_len, 256, true);
 }
\ No newline at end of file
@@ -1,25 +1,139 @@
-#pragma once
-
-#include <iostream>
-#include <cstdint>
-#include <vector>
-
-namespace SHA3 {
-    uint8_t SHA3_224(const uint8_t* data, size_t len, uint8_t* digest);
-    uint8_t SHA3_224(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest);
-
-    uint8_t SHA3_256(const uint8_t* data, size_t len, uint8_t* digest);
-    uint8_t SHA3_256(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest);
-
-    uint8_t SHA3_384(const uint8_t* data, size_t len, uint8_t* digest);
-    uint8_t SHA3_384(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest);
-
-    uint8_t SHA3_512(const uint8_t* data, size_t len, uint8_t* digest);
-    uint8_t SHA3_512(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest);
-
-    uint8_t SHAKE128(const uint8_t* data, size_t len, uint8_t* digest, size_t digest_len);
-    uint8_t SHAKE128(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest, size_t digest_len);
-
-    uint8_t SHAKE256(const uint8_t* data, size_t len, uint8_t* digest, size_t digest_len);
-    uint8_t SHAKE256(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest, size_t digest_len);
+#pragma once
+
+#include <iostream>
+#include <cstdint>
+#include <vector>
+
+#include "sha3_internal.hpp"
+
+namespace SHA3 {
+    uint8_t SHA3_224(const uint8_t* data, size_t len, uint8_t* digest);
+    uint8_t SHA3_224(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest);
+
+    uint8_t SHA3_256(const uint8_t* data, size_t len, uint8_t* digest);
+    uint8_t SHA3_256(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest);
+
+    uint8_t SHA3_384(const uint8_t* data, size_t len, uint8_t* digest);
+    uint8_t SHA3_384(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest);
+
+    uint8_t SHA3_512(const uint8_t* data, size_t len, uint8_t* digest);
+    uint8_t SHA3_512(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest);
+
+    uint8_t SHAKE128(const uint8_t* data, size_t len, uint8_t* digest, size_t digest_len);
+    uint8_t SHAKE128(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest, size_t digest_len);
+
+    uint8_t SHAKE256(const uint8_t* data, size_t len, uint8_t* digest, size_t digest_len);
+    uint8_t SHAKE256(const std::vector<uint8_t>& data, std::vector<uint8_t>& digest, size_t digest_len);
+
+    // incremental SHA3-<bitsize>, for inputs that are not available (or not known in size) all at once
+    template<uint16_t bitsize> class context {
+        static_assert(bitsize == 224 || bitsize == 256 || bitsize == 384 || bitsize == 512);
+    public:
+        static constexpr size_t digest_size = bitsize / 8;
+
+        context() {
+            internal::internal_init<bitsize>(ctx);
+        }
+
+        uint8_t update(const uint8_t* data, size_t len) {
+            if (finalized) {
+                return internal::SHA3_RETURN_BAD_PARAMS;
+            }
+            internal::internal_update(ctx, data, len);
+            return internal::SHA3_RETURN_OK;
+        }
+        uint8_t update(const std::vector<uint8_t>& data) {
+            return update(data.data(), data.size());
+        }
+
+        // writes the <digest_size> bytes digest, nothing can be absorbed afterwards
+        uint8_t finalize(uint8_t* digest) {
+            if (finalized) {
+                return internal::SHA3_RETURN_BAD_PARAMS;
+            }
+            memcpy(digest, internal::internal_finalize(ctx), digest_size);
+            finalized = true;
+            return internal::SHA3_RETURN_OK;
+        }
+        uint8_t finalize(std::vector<uint8_t>& digest) {
+            digest.resize(digest_size);
+            return finalize(digest.data());
+        }
+    private:
+        internal::sha3_context ctx;
+        bool finalized = false;
+    };
+
+    // several independent inputs hashed at once: digest[i] receives the hash of the len[i] bytes at data[i],
+    // groups of width() inputs go through one SIMD permutation (8 with AVX-512, 4 with AVX2, 1 otherwise)
+    namespace batch {
+        size_t width();
+
+        uint8_t SHA3_224(size_t n, const uint8_t* const data[], const size_t len[], uint8_t* const digest[]);
+        uint8_t SHA3_256(size_t n, const uint8_t* const data[], const size_t len[], uint8_t* const digest[]);
+        uint8_t SHA3_384(size_t n, const uint8_t* const data[], const size_t len[], uint8_t* const digest[]);
+        uint8_t SHA3_512(size_t n, const uint8_t* const data[], const size_t len[], uint8_t* const digest[]);
+
+        uint8_t SHAKE128(size_t n, const uint8_t* const data[], const size_t len[], uint8_t* const digest[], size_t digest_len);
+        uint8_t SHAKE256(size_t n, const uint8_t* const data[], const size_t len[], uint8_t* const digest[], size_t digest_len);
+    }
+
+    namespace SHAKE {
+        // incremental SHAKE<bitsize> sponge: absorb with update(), then finalize() once and squeeze()
+        // as much output as needed, copying a context snapshots everything absorbed so far
+        template<uint16_t bitsize> class context {
+            static_assert(bitsize == 128 || bitsize == 256);
+        public:
+            context() {
+                internal::internal_init<bitsize>(ctx);
+            }
+
+            uint8_t update(const uint8_t* data, size_t len) {
+                if (finalized) {
+                    return internal::SHA3_RETURN_BAD_PARAMS;
+                }
+                internal::internal_update(ctx, data, len);
+                return internal::SHA3_RETURN_OK;
+            }
+            uint8_t update(const std::vector<uint8_t>& data) {
+                return update(data.data(), data.size());
+            }
+
+            // pads the absorbed data, nothing can be absorbed afterwards
+            uint8_t finalize() {
+                if (finalized) {
+                    return internal::SHA3_RETURN_BAD_PARAMS;
+                }
+                internal::internal_finalizeXOF(ctx);
+                finalized = true;
+                return internal::SHA3_RETURN_OK;
+            }
+
+            // reads the next <len> bytes of output, successive calls continue where the previous one stopped
+            uint8_t squeeze(uint8_t* out, size_t len) {
+                if (!finalized) {
+                    return internal::SHA3_RETURN_BAD_PARAMS;
+                }
+                internal::internal_squeeze(ctx, out, len);
+                return internal::SHA3_RETURN_OK;
+            }
+            uint8_t squeeze(std::vector<uint8_t>& out, size_t len) {
+                out.resize(len);
+                return squeeze(out.data(), len);
+            }
+
+            // first <digest_len> bytes of output for the data absorbed so far, the context itself is left untouched
+            uint8_t digest(uint8_t* digest, size_t digest_len) const {
+                if (finalized) {
+                    return internal::SHA3_RETURN_BAD_PARAMS;
+                }
+                context c = *this;
+                c.finalize();
+                return c.squeeze(digest, digest_len);
+            }
+        private:
+            internal::sha3_context ctx;
+            bool finalized = false;
+        };
+    }
 }
\ No newline at end of file
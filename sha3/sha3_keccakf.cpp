@@ -0,0 +1,205 @@
+#include <iostream>
+#include <bit>
+
+#include "sha3_internal.hpp"
+
+using namespace SHA3::internal;
+
+// fully unrolled Keccak-f[1600], the 25 lanes live in local variables for the whole permutation and every
+// index, rotation and round constant is known at compile time (lane naming and scheduling follow the
+// Keccak team's reference "opt64" implementation)
+
+void SHA3::internal::keccakf_unrolled(uint64_t s[25]) {
+    uint64_t Aba = s[0], Abe = s[1], Abi = s[2], Abo = s[3], Abu = s[4];
+    uint64_t Aga = s[5], Age = s[6], Agi = s[7], Ago = s[8], Agu = s[9];
+    uint64_t Aka = s[10], Ake = s[11], Aki = s[12], Ako = s[13], Aku = s[14];
+    uint64_t Ama = s[15], Ame = s[16], Ami = s[17], Amo = s[18], Amu = s[19];
+    uint64_t Asa = s[20], Ase = s[21], Asi = s[22], Aso = s[23], Asu = s[24];
+
+#pragma GCC unroll 24
+    for (size_t round = 0; round < KECCAK_ROUNDS; ++round) {
+        const uint64_t Ca = Aba ^ Aga ^ Aka ^ Ama ^ Asa;
+        const uint64_t Ce = Abe ^ Age ^ Ake ^ Ame ^ Ase;
+        const uint64_t Ci = Abi ^ Agi ^ Aki ^ Ami ^ Asi;
+        const uint64_t Co = Abo ^ Ago ^ Ako ^ Amo ^ Aso;
+        const uint64_t Cu = Abu ^ Agu ^ Aku ^ Amu ^ Asu;
+
+        const uint64_t Da = Cu ^ std::rotl(Ce, 1);
+        const uint64_t De = Ca ^ std::rotl(Ci, 1);
+        const uint64_t Di = Ce ^ std::rotl(Co, 1);
+        const uint64_t Do = Ci ^ std::rotl(Cu, 1);
+        const uint64_t Du = Co ^ std::rotl(Ca, 1);
+
+        const uint64_t Bba = Aba ^ Da;
+        const uint64_t Bbe = std::rotl(Age ^ De, 44);
+        const uint64_t Bbi = std::rotl(Aki ^ Di, 43);
+        const uint64_t Bbo = std::rotl(Amo ^ Do, 21);
+        const uint64_t Bbu = std::rotl(Asu ^ Du, 14);
+
+        const uint64_t Bga = std::rotl(Abo ^ Do, 28);
+        const uint64_t Bge = std::rotl(Agu ^ Du, 20);
+        const uint64_t Bgi = std::rotl(Aka ^ Da, 3);
+        const uint64_t Bgo = std::rotl(Ame ^ De, 45);
+        const uint64_t Bgu = std::rotl(Asi ^ Di, 61);
+
+        const uint64_t Bka = std::rotl(Abe ^ De, 1);
+        const uint64_t Bke = std::rotl(Agi ^ Di, 6);
+        const uint64_t Bki = std::rotl(Ako ^ Do, 25);
+        const uint64_t Bko = std::rotl(Amu ^ Du, 8);
+        const uint64_t Bku = std::rotl(Asa ^ Da, 18);
+
+        const uint64_t Bma = std::rotl(Abu ^ Du, 27);
+        const uint64_t Bme = std::rotl(Aga ^ Da, 36);
+        const uint64_t Bmi = std::rotl(Ake ^ De, 10);
+        const uint64_t Bmo = std::rotl(Ami ^ Di, 15);
+        const uint64_t Bmu = std::rotl(Aso ^ Do, 56);
+
+        const uint64_t Bsa = std::rotl(Abi ^ Di, 62);
+        const uint64_t Bse = std::rotl(Ago ^ Do, 55);
+        const uint64_t Bsi = std::rotl(Aku ^ Du, 39);
+        const uint64_t Bso = std::rotl(Ama ^ Da, 41);
+        const uint64_t Bsu = std::rotl(Ase ^ De, 2);
+
+        Aba = Bba ^ (~Bbe & Bbi) ^ keccakf_rndc[round];
+        Abe = Bbe ^ (~Bbi & Bbo);
+        Abi = Bbi ^ (~Bbo & Bbu);
+        Abo = Bbo ^ (~Bbu & Bba);
+        Abu = Bbu ^ (~Bba & Bbe);
+
+        Aga = Bga ^ (~Bge & Bgi);
+        Age = Bge ^ (~Bgi & Bgo);
+        Agi = Bgi ^ (~Bgo & Bgu);
+        Ago = Bgo ^ (~Bgu & Bga);
+        Agu = Bgu ^ (~Bga & Bge);
+
+        Aka = Bka ^ (~Bke & Bki);
+        Ake = Bke ^ (~Bki & Bko);
+        Aki = Bki ^ (~Bko & Bku);
+        Ako = Bko ^ (~Bku & Bka);
+        Aku = Bku ^ (~Bka & Bke);
+
+        Ama = Bma ^ (~Bme & Bmi);
+        Ame = Bme ^ (~Bmi & Bmo);
+        Ami = Bmi ^ (~Bmo & Bmu);
+        Amo = Bmo ^ (~Bmu & Bma);
+        Amu = Bmu ^ (~Bma & Bme);
+
+        Asa = Bsa ^ (~Bse & Bsi);
+        Ase = Bse ^ (~Bsi & Bso);
+        Asi = Bsi ^ (~Bso & Bsu);
+        Aso = Bso ^ (~Bsu & Bsa);
+        Asu = Bsu ^ (~Bsa & Bse);
+    }
+
+    s[0] = Aba; s[1] = Abe; s[2] = Abi; s[3] = Abo; s[4] = Abu;
+    s[5] = Aga; s[6] = Age; s[7] = Agi; s[8] = Ago; s[9] = Agu;
+    s[10] = Aka; s[11] = Ake; s[12] = Aki; s[13] = Ako; s[14] = Aku;
+    s[15] = Ama; s[16] = Ame; s[17] = Ami; s[18] = Amo; s[19] = Amu;
+    s[20] = Asa; s[21] = Ase; s[22] = Asi; s[23] = Aso; s[24] = Asu;
+}
+
+// same permutation with the "lane complementing" transform: lanes 1, 2, 8, 12, 17 and 20 are kept complemented
+// between rounds, which removes most of the NOT operations of the chi step (useful on targets without andn)
+
+void SHA3::internal::keccakf_lane_complement(uint64_t s[25]) {
+    s[1] = ~s[1];
+    s[2] = ~s[2];
+    s[8] = ~s[8];
+    s[12] = ~s[12];
+    s[17] = ~s[17];
+    s[20] = ~s[20];
+
+    uint64_t Aba = s[0], Abe = s[1], Abi = s[2], Abo = s[3], Abu = s[4];
+    uint64_t Aga = s[5], Age = s[6], Agi = s[7], Ago = s[8], Agu = s[9];
+    uint64_t Aka = s[10], Ake = s[11], Aki = s[12], Ako = s[13], Aku = s[14];
+    uint64_t Ama = s[15], Ame = s[16], Ami = s[17], Amo = s[18], Amu = s[19];
+    uint64_t Asa = s[20], Ase = s[21], Asi = s[22], Aso = s[23], Asu = s[24];
+
+#pragma GCC unroll 24
+    for (size_t round = 0; round < KECCAK_ROUNDS; ++round) {
+        const uint64_t Ca = Aba ^ Aga ^ Aka ^ Ama ^ Asa;
+        const uint64_t Ce = Abe ^ Age ^ Ake ^ Ame ^ Ase;
+        const uint64_t Ci = Abi ^ Agi ^ Aki ^ Ami ^ Asi;
+        const uint64_t Co = Abo ^ Ago ^ Ako ^ Amo ^ Aso;
+        const uint64_t Cu = Abu ^ Agu ^ Aku ^ Amu ^ Asu;
+
+        const uint64_t Da = Cu ^ std::rotl(Ce, 1);
+        const uint64_t De = Ca ^ std::rotl(Ci, 1);
+        const uint64_t Di = Ce ^ std::rotl(Co, 1);
+        const uint64_t Do = Ci ^ std::rotl(Cu, 1);
+        const uint64_t Du = Co ^ std::rotl(Ca, 1);
+
+        const uint64_t Bba = Aba ^ Da;
+        const uint64_t Bbe = std::rotl(Age ^ De, 44);
+        const uint64_t Bbi = std::rotl(Aki ^ Di, 43);
+        const uint64_t Bbo = std::rotl(Amo ^ Do, 21);
+        const uint64_t Bbu = std::rotl(Asu ^ Du, 14);
+
+        const uint64_t Bga = std::rotl(Abo ^ Do, 28);
+        const uint64_t Bge = std::rotl(Agu ^ Du, 20);
+        const uint64_t Bgi = std::rotl(Aka ^ Da, 3);
+        const uint64_t Bgo = std::rotl(Ame ^ De, 45);
+        const uint64_t Bgu = std::rotl(Asi ^ Di, 61);
+
+        const uint64_t Bka = std::rotl(Abe ^ De, 1);
+        const uint64_t Bke = std::rotl(Agi ^ Di, 6);
+        const uint64_t Bki = std::rotl(Ako ^ Do, 25);
+        const uint64_t Bko = std::rotl(Amu ^ Du, 8);
+        const uint64_t Bku = std::rotl(Asa ^ Da, 18);
+
+        const uint64_t Bma = std::rotl(Abu ^ Du, 27);
+        const uint64_t Bme = std::rotl(Aga ^ Da, 36);
+        const uint64_t Bmi = std::rotl(Ake ^ De, 10);
+        const uint64_t Bmo = std::rotl(Ami ^ Di, 15);
+        const uint64_t Bmu = std::rotl(Aso ^ Do, 56);
+
+        const uint64_t Bsa = std::rotl(Abi ^ Di, 62);
+        const uint64_t Bse = std::rotl(Ago ^ Do, 55);
+        const uint64_t Bsi = std::rotl(Aku ^ Du, 39);
+        const uint64_t Bso = std::rotl(Ama ^ Da, 41);
+        const uint64_t Bsu = std::rotl(Ase ^ De, 2);
+
+        Aba = Bba ^ (Bbe | Bbi) ^ keccakf_rndc[round];
+        Abe = Bbe ^ (~Bbi | Bbo);
+        Abi = Bbi ^ (Bbo & Bbu);
+        Abo = Bbo ^ (Bbu | Bba);
+        Abu = Bbu ^ (Bba & Bbe);
+
+        Aga = Bga ^ (Bge | Bgi);
+        Age = Bge ^ (Bgi & Bgo);
+        Agi = Bgi ^ (Bgo | ~Bgu);
+        Ago = Bgo ^ (Bgu | Bga);
+        Agu = Bgu ^ (Bga & Bge);
+
+        Aka = Bka ^ (Bke | Bki);
+        Ake = Bke ^ (Bki & Bko);
+        Aki = Bki ^ (~Bko & Bku);
+        Ako = ~Bko ^ (Bku | Bka);
+        Aku = Bku ^ (Bka & Bke);
+
+        Ama = Bma ^ (Bme & Bmi);
+        Ame = Bme ^ (Bmi | Bmo);
+        Ami = Bmi ^ (~Bmo | Bmu);
+        Amo = ~Bmo ^ (Bmu & Bma);
+        Amu = Bmu ^ (Bma | Bme);
+
+        Asa = Bsa ^ (~Bse & Bsi);
+        Ase = ~Bse ^ (Bsi | Bso);
+        Asi = Bsi ^ (Bso & Bsu);
+        Aso = Bso ^ (Bsu | Bsa);
+        Asu = Bsu ^ (Bsa & Bse);
+    }
+
+    s[0] = Aba; s[1] = Abe; s[2] = Abi; s[3] = Abo; s[4] = Abu;
+    s[5] = Aga; s[6] = Age; s[7] = Agi; s[8] = Ago; s[9] = Agu;
+    s[10] = Aka; s[11] = Ake; s[12] = Aki; s[13] = Ako; s[14] = Aku;
+    s[15] = Ama; s[16] = Ame; s[17] = Ami; s[18] = Amo; s[19] = Amu;
+    s[20] = Asa; s[21] = Ase; s[22] = Asi; s[23] = Aso; s[24] = Asu;
+
+    s[1] = ~s[1];
+    s[2] = ~s[2];
+    s[8] = ~s[8];
+    s[12] = ~s[12];
+    s[17] = ~s[17];
+    s[20] = ~s[20];
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <iostream>
+#include <cstdint>
+
+#include "sha3_internal.hpp"
+
+// Keccak-f[1600] on several independent states at once, V is a SIMD vector of 64-bit lanes (GCC/Clang
+// vector extension) holding the same lane of every state, the target-specific translation units
+// instantiate it with the vector width their instruction set provides
+
+namespace SHA3 {
+    namespace internal {
+        namespace {
+            template<int n, typename V> inline V lanes_rotl(V x) {
+                return (x << n) | (x >> (64 - n));
+            }
+
+            template<typename V> inline void keccakf_lanes(V s[25]) {
+                V Aba = s[0], Abe = s[1], Abi = s[2], Abo = s[3], Abu = s[4];
+                V Aga = s[5], Age = s[6], Agi = s[7], Ago = s[8], Agu = s[9];
+                V Aka = s[10], Ake = s[11], Aki = s[12], Ako = s[13], Aku = s[14];
+                V Ama = s[15], Ame = s[16], Ami = s[17], Amo = s[18], Amu = s[19];
+                V Asa = s[20], Ase = s[21], Asi = s[22], Aso = s[23], Asu = s[24];
+
+#pragma GCC unroll 24
+                for (size_t round = 0; round < KECCAK_ROUNDS; ++round) {
+                    const V Ca = Aba ^ Aga ^ Aka ^ Ama ^ Asa;
+                    const V Ce = Abe ^ Age ^ Ake ^ Ame ^ Ase;
+                    const V Ci = Abi ^ Agi ^ Aki ^ Ami ^ Asi;
+                    const V Co = Abo ^ Ago ^ Ako ^ Amo ^ Aso;
+                    const V Cu = Abu ^ Agu ^ Aku ^ Amu ^ Asu;
+
+                    const V Da = Cu ^ lanes_rotl<1>(Ce);
+                    const V De = Ca ^ lanes_rotl<1>(Ci);
+                    const V Di = Ce ^ lanes_rotl<1>(Co);
+                    const V Do = Ci ^ lanes_rotl<1>(Cu);
+                    const V Du = Co ^ lanes_rotl<1>(Ca);
+
+                    const V Bba = Aba ^ Da;
+                    const V Bbe = lanes_rotl<44>(Age ^ De);
+                    const V Bbi = lanes_rotl<43>(Aki ^ Di);
+                    const V Bbo = lanes_rotl<21>(Amo ^ Do);
+                    const V Bbu = lanes_rotl<14>(Asu ^ Du);
+
+                    const V Bga = lanes_rotl<28>(Abo ^ Do);
+                    const V Bge = lanes_rotl<20>(Agu ^ Du);
+                    const V Bgi = lanes_rotl<3>(Aka ^ Da);
+                    const V Bgo = lanes_rotl<45>(Ame ^ De);
+                    const V Bgu = lanes_rotl<61>(Asi ^ Di);
+
+                    const V Bka = lanes_rotl<1>(Abe ^ De);
+                    const V Bke = lanes_rotl<6>(Agi ^ Di);
+                    const V Bki = lanes_rotl<25>(Ako ^ Do);
+                    const V Bko = lanes_rotl<8>(Amu ^ Du);
+                    const V Bku = lanes_rotl<18>(Asa ^ Da);
+
+                    const V Bma = lanes_rotl<27>(Abu ^ Du);
+                    const V Bme = lanes_rotl<36>(Aga ^ Da);
+                    const V Bmi = lanes_rotl<10>(Ake ^ De);
+                    const V Bmo = lanes_rotl<15>(Ami ^ Di);
+                    const V Bmu = lanes_rotl<56>(Aso ^ Do);
+
+                    const V Bsa = lanes_rotl<62>(Abi ^ Di);
+                    const V Bse = lanes_rotl<55>(Ago ^ Do);
+                    const V Bsi = lanes_rotl<39>(Aku ^ Du);
+                    const V Bso = lanes_rotl<41>(Ama ^ Da);
+                    const V Bsu = lanes_rotl<2>(Ase ^ De);
+
+                    Aba = Bba ^ (~Bbe & Bbi) ^ keccakf_rndc[round];
+                    Abe = Bbe ^ (~Bbi & Bbo);
+                    Abi = Bbi ^ (~Bbo & Bbu);
+                    Abo = Bbo ^ (~Bbu & Bba);
+                    Abu = Bbu ^ (~Bba & Bbe);
+
+                    Aga = Bga ^ (~Bge & Bgi);
+                    Age = Bge ^ (~Bgi & Bgo);
+                    Agi = Bgi ^ (~Bgo & Bgu);
+                    Ago = Bgo ^ (~Bgu & Bga);
+                    Agu = Bgu ^ (~Bga & Bge);
+
+                    Aka = Bka ^ (~Bke & Bki);
+                    Ake = Bke ^ (~Bki & Bko);
+                    Aki = Bki ^ (~Bko & Bku);
+                    Ako = Bko ^ (~Bku & Bka);
+                    Aku = Bku ^ (~Bka & Bke);
+
+                    Ama = Bma ^ (~Bme & Bmi);
+                    Ame = Bme ^ (~Bmi & Bmo);
+                    Ami = Bmi ^ (~Bmo & Bmu);
+                    Amo = Bmo ^ (~Bmu & Bma);
+                    Amu = Bmu ^ (~Bma & Bme);
+
+                    Asa = Bsa ^ (~Bse & Bsi);
+                    Ase = Bse ^ (~Bsi & Bso);
+                    Asi = Bsi ^ (~Bso & Bsu);
+                    Aso = Bso ^ (~Bsu & Bsa);
+                    Asu = Bsu ^ (~Bsa & Bse);
+                }
+
+                s[0] = Aba; s[1] = Abe; s[2] = Abi; s[3] = Abo; s[4] = Abu;
+                s[5] = Aga; s[6] = Age; s[7] = Agi; s[8] = Ago; s[9] = Agu;
+                s[10] = Aka; s[11] = Ake; s[12] = Aki; s[13] = Ako; s[14] = Aku;
+                s[15] = Ama; s[16] = Ame; s[17] = Ami; s[18] = Amo; s[19] = Amu;
+                s[20] = Asa; s[21] = Ase; s[22] = Asi; s[23] = Aso; s[24] = Asu;
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+
+#include "sha3_internal.hpp"
+
+using namespace SHA3::internal;
+
+namespace {
+    constexpr size_t max_width = 8;
+
+    struct multi_permutation {
+        size_t width;
+        void(*keccakf)(uint64_t*);
+    };
+
+    multi_permutation select_permutation() {
+#if defined(SHA3_HAVE_AVX512)
+        if (__builtin_cpu_supports("avx512f")) {
+            return { 8, &keccakf_x8 };
+        }
+#endif
+#if defined(SHA3_HAVE_AVX2)
+        if (__builtin_cpu_supports("avx2")) {
+            return { 4, &keccakf_x4 };
+        }
+#endif
+        return { 1, nullptr };
+    }
+
+    const multi_permutation& get_permutation() {
+        static const multi_permutation permutation = select_permutation();
+        return permutation;
+    }
+
+    inline uint64_t load_lane(const uint8_t* buf) {
+        return (uint64_t) (buf[0]) |
+            ((uint64_t) (buf[1]) << 8 * 1) |
+            ((uint64_t) (buf[2]) << 8 * 2) |
+            ((uint64_t) (buf[3]) << 8 * 3) |
+            ((uint64_t) (buf[4]) << 8 * 4) |
+            ((uint64_t) (buf[5]) << 8 * 5) |
+            ((uint64_t) (buf[6]) << 8 * 6) |
+            ((uint64_t) (buf[7]) << 8 * 7);
+    }
+
+    // xors block <block> of a message into state <lane> of the interleaved states, the last block gets the
+    // domain separation suffix and the final bit of the padding
+    void absorb_block(uint64_t* s, size_t width, size_t lane, const uint8_t* data, size_t len, size_t block, size_t rate, uint8_t suffix) {
+        const size_t offset = block * rate;
+        const uint8_t* src = data + offset;
+
+        uint8_t padded[SHA3_KECCAK_SPONGE_WORDS * sizeof(uint64_t)];
+        if (len - offset < rate) {
+            const size_t tail = len - offset;
+            memset(padded, 0, rate);
+            memcpy(padded, src, tail);
+            padded[tail] ^= suffix;
+            padded[rate - 1] ^= 0x80;
+            src = padded;
+        }
+
+        for (size_t i = 0; i < rate / sizeof(uint64_t); ++i) {
+            s[i * width + lane] ^= load_lane(src + i * sizeof(uint64_t));
+        }
+    }
+
+    // hashes up to <width> messages in lockstep, messages may have different lengths: a message that is done
+    // keeps being permuted along with the others, but its output has been read by then
+    void hash_group(const multi_permutation& permutation, size_t n, const uint8_t* const data[], const size_t len[],
+            uint8_t* const digest[], size_t digest_len, size_t capacity_words, uint8_t suffix) {
+        const size_t width = permutation.width;
+        const size_t rate = (SHA3_KECCAK_SPONGE_WORDS - capacity_words) * sizeof(uint64_t);
+
+        alignas(64) uint64_t s[SHA3_KECCAK_SPONGE_WORDS * max_width] = { 0 };
+
+        size_t blocks[max_width] = { 0 };
+        size_t max_blocks = 0;
+        for (size_t j = 0; j < n; ++j) {
+            blocks[j] = len[j] / rate + 1;
+            max_blocks = std::max(max_blocks, blocks[j]);
+        }
+
+        for (size_t b = 0; b < max_blocks; ++b) {
+            for (size_t j = 0; j < n; ++j) {
+                if (b < blocks[j]) {
+                    absorb_block(s, width, j, data[j], len[j], b, rate, suffix);
+                }
+            }
+
+            permutation.keccakf(s);
+
+            for (size_t j = 0; j < n; ++j) {
+                if (b + 1 == blocks[j]) {
+                    sha3_context c;
+                    c.capacityWords = capacity_words;
+                    for (size_t i = 0; i < SHA3_KECCAK_SPONGE_WORDS; ++i) {
+                        c.state.s[i] = s[i * width + j];
+                    }
+
+                    internal_set_squeezing(c);
+                    internal_squeeze(c, digest[j], digest_len);
+                }
+            }
+        }
+    }
+}
+
+size_t SHA3::internal::internal_multi_width() {
+    return get_permutation().width;
+}
+
+uint8_t SHA3::internal::internal_sha3_multi(size_t n, const uint8_t* const data[], const size_t len[], uint8_t* const digest[],
+        size_t digest_len, uint16_t bitsize, bool xof) {
+    if (bitsize != 128 && bitsize != 224 && bitsize != 256 && bitsize != 384 && bitsize != 512) {
+        return SHA3_RETURN_BAD_PARAMS;
+    }
+
+    const size_t capacity_words = 2 * bitsize / (8 * sizeof(uint64_t));
+    const uint8_t suffix = xof ? 0x1f : 0x06;
+    const multi_permutation& permutation = get_permutation();
+
+    if (permutation.width == 1) {
+        for (size_t i = 0; i < n; ++i) {
+            sha3_context c;
+            c.capacityWords = capacity_words;
+            internal_update(c, data[i], len[i]);
+
+            if (xof) {
+                internal_finalizeXOF(c);
+                internal_squeeze(c, digest[i], digest_len);
+            }
+            else {
+                memcpy(digest[i], internal_finalize(c), digest_len);
+            }
+        }
+        return SHA3_RETURN_OK;
+    }
+
+    for (size_t i = 0; i < n; i += permutation.width) {
+        const size_t group = std::min(permutation.width, n - i);
+        hash_group(permutation, group, data + i, len + i, digest + i, digest_len, capacity_words, suffix);
+    }
+
+    return SHA3_RETURN_OK;
+}
@@ -0,0 +1,16 @@
+#include <cstring>
+
+#include "sha3_lanes.hpp"
+
+// built with -mavx2, only called after checking that the CPU supports it
+
+namespace {
+    typedef uint64_t lanes4 __attribute__((vector_size(32)));
+}
+
+void SHA3::internal::keccakf_x4(uint64_t s[25 * 4]) {
+    lanes4 v[25];
+    memcpy(v, s, sizeof(v));
+    keccakf_lanes(v);
+    memcpy(s, v, sizeof(v));
+}
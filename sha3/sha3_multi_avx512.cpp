@@ -0,0 +1,16 @@
+#include <cstring>
+
+#include "sha3_lanes.hpp"
+
+// built with -mavx512f, only called after checking that the CPU supports it
+
+namespace {
+    typedef uint64_t lanes8 __attribute__((vector_size(64)));
+}
+
+void SHA3::internal::keccakf_x8(uint64_t s[25 * 8]) {
+    lanes8 v[25];
+    memcpy(v, s, sizeof(v));
+    keccakf_lanes(v);
+    memcpy(s, v, sizeof(v));
+}